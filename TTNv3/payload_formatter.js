@@ -1,11 +1,241 @@
+function decodeReading(bytes) {
+  var data = {};
+
+  data.version = bytes[0];
+  data.counter = (bytes[1] << 8) | bytes[2];
+
+  if (bytes[3] !== 0xff) {
+    data.battery = (2000 + bytes[3] * 20) / 1000;
+  }
+
+  data.rssi = bytes[4] > 127 ? bytes[4] - 256 : bytes[4];
+
+  return data;
+}
+
+function decodeBatch(bytes) {
+  var data = {};
+  var count = bytes[1];
+
+  data.version = bytes[0];
+  data.counter = (bytes[2] << 8) | bytes[3];
+  data.interval = (bytes[4] << 8) | bytes[5];
+  data.readings = [];
+
+  for (var i = 0; i < count; i++) {
+    var reading = decodeReading([1, 0, 0, bytes[6 + i * 2], bytes[7 + i * 2]]);
+    data.readings.push({
+      // seconds before the uplink, the last reading is the newest
+      age: (count - 1 - i) * data.interval,
+      battery: reading.battery,
+      rssi: reading.rssi
+    });
+  }
+
+  return data;
+}
+
+function decodeSeries(bytes, offset, count, zigzagFirst) {
+  var pos = offset;
+
+  function varint() {
+    var value = 0;
+    var shift = 0;
+    var b;
+    do {
+      b = bytes[pos++];
+      value += (b & 0x7f) * Math.pow(2, shift);
+      shift += 7;
+    } while (b & 0x80);
+    return value;
+  }
+
+  function unzigzag(value) {
+    return value % 2 ? -(value + 1) / 2 : value / 2;
+  }
+
+  var values = [];
+  var first = varint();
+  values.push(zigzagFirst ? unzigzag(first) : first);
+
+  var mode = bytes[pos++];
+  var bit = 0;
+  for (var i = 1; i < count; i++) {
+    var delta = 0;
+    if (mode === 0xff) {
+      delta = varint();
+    } else {
+      for (var b = 0; b < mode; b++, bit++) {
+        delta = delta * 2 + ((bytes[pos + (bit >> 3)] >> (7 - (bit & 7))) & 1);
+      }
+    }
+    values.push(values[i - 1] + unzigzag(delta));
+  }
+  if (mode !== 0xff) {
+    pos += (bit + 7) >> 3;
+  }
+
+  return { values: values, next: pos };
+}
+
+function decodeDeltaBatch(bytes) {
+  var data = {};
+  var count = bytes[1];
+
+  data.version = bytes[0];
+  data.counter = (bytes[2] << 8) | bytes[3];
+  data.interval = (bytes[4] << 8) | bytes[5];
+  data.readings = [];
+
+  var battery = decodeSeries(bytes, 6, count, false);
+  var rssi = decodeSeries(bytes, battery.next, count, true);
+
+  for (var i = 0; i < count; i++) {
+    var reading = decodeReading([1, 0, 0, battery.values[i], rssi.values[i] & 0xff]);
+    data.readings.push({
+      age: (count - 1 - i) * data.interval,
+      battery: reading.battery,
+      rssi: reading.rssi
+    });
+  }
+
+  return data;
+}
+
+// FPorts of lib/Downlink/Downlink.hpp, LoRaWANHandler.hpp and UplinkScheduler.hpp
+var DOWNLINK_PORT = 10;
+var DIAGNOSTICS_PORT = 11;
+var ALARM_PORT = 12;
+var BACKLOG_PORT = 13;
+var COALESCED_PORT = 20;
+
+function decodeDiagnostics(bytes) {
+  function uint16(pos) {
+    return (bytes[pos] << 8) | bytes[pos + 1];
+  }
+
+  var jitter = uint16(19);
+
+  return {
+    version: bytes[0],
+    interval: uint16(1),
+    spreadingFactor: bytes[3],
+    txPower: bytes[4] > 127 ? bytes[4] - 256 : bytes[4],
+    adr: (bytes[5] & 0x01) !== 0,
+    display: (bytes[5] & 0x02) !== 0,
+    batchMax: bytes[6],
+    uptime: ((bytes[7] << 24) >>> 0) + ((bytes[8] << 16) | uint16(9)),
+    downlinksAccepted: uint16(11),
+    downlinksRejected: uint16(13),
+    eventsDropped: uint16(15),
+    flashCommits: uint16(17),
+    rx1JitterUs: jitter > 32767 ? jitter - 65536 : jitter
+  };
+}
+
+// version 2, link statistics of the recent uplinks after the version 1 fields
+function decodeLinkStats(bytes) {
+  function int8(pos) {
+    return bytes[pos] > 127 ? bytes[pos] - 256 : bytes[pos];
+  }
+
+  var link = {
+    uplinks: bytes[21],
+    rx1: bytes[22],
+    rx2: bytes[23],
+    confirmed: bytes[24],
+    acked: bytes[25],
+    rssi: int8(26),
+    snr: int8(27),
+    airtimeMs: (bytes[28] << 8) | bytes[29],
+    spreadingFactors: {},
+    rssiBins: {}
+  };
+  for (var sf = 0; sf < 6; sf++) {
+    link.spreadingFactors["SF" + (7 + sf)] = bytes[30 + sf];
+  }
+  // lower edge of each 10 dB bin, the first one holds everything below -120 dBm
+  for (var bin = 0; bin < 8; bin++) {
+    link.rssiBins[-130 + bin * 10] = bytes[36 + bin];
+  }
+  return link;
+}
+
 function decodeUplink(input) {
   var data = {};
-  
-  data.message = String.fromCharCode.apply(null, input.bytes);
-  
+  var bytes = input.bytes;
+
+  if (input.fPort === COALESCED_PORT) {
+    // port, length, payload of each stream
+    data.payloads = [];
+    for (var pos = 0; pos + 2 <= bytes.length; pos += 2 + bytes[pos + 1]) {
+      var payload = bytes.slice(pos + 2, pos + 2 + bytes[pos + 1]);
+      var decoded = decodeUplink({ fPort: bytes[pos], bytes: payload }).data;
+      decoded.fPort = bytes[pos];
+      data.payloads.push(decoded);
+    }
+  } else if (input.fPort === BACKLOG_PORT) {
+    // telemetry sent late, after the link was down
+    data = decodeUplink({ fPort: 1, bytes: bytes }).data;
+    data.backlog = true;
+  } else if (input.fPort === ALARM_PORT) {
+    data.alarm = bytes;
+  } else if (input.fPort === DIAGNOSTICS_PORT && bytes.length === 21 && bytes[0] === 1) {
+    data = decodeDiagnostics(bytes);
+  } else if (input.fPort === DIAGNOSTICS_PORT && bytes.length === 44 && bytes[0] === 2) {
+    data = decodeDiagnostics(bytes);
+    data.link = decodeLinkStats(bytes);
+  } else if (bytes.length === 5 && bytes[0] === 1) {
+    data = decodeReading(bytes);
+  } else if (bytes.length >= 6 && bytes[0] === 2 && bytes.length === 6 + bytes[1] * 2) {
+    data = decodeBatch(bytes);
+  } else if (bytes.length >= 8 && bytes[0] === 3) {
+    data = decodeDeltaBatch(bytes);
+  } else {
+    // firmware up to 1.1.5 sends a text message
+    data.message = String.fromCharCode.apply(null, bytes);
+  }
+
   return {
     data: data,
     warnings: [],
     errors: []
   };
 }
+
+// {"interval": 300, "spreadingFactor": 9, "txPower": 14, "adr": true,
+//  "batchMax": 4, "display": false, "diagnostics": true}, any subset
+function encodeDownlink(input) {
+  var data = input.data;
+  var bytes = [];
+  var errors = [];
+
+  if (data.interval !== undefined) {
+    bytes.push(0x01, (data.interval >> 8) & 0xff, data.interval & 0xff);
+  }
+  if (data.spreadingFactor !== undefined) {
+    bytes.push(0x02, data.spreadingFactor, (data.txPower === undefined ? 14 : data.txPower) & 0xff);
+  }
+  if (data.adr !== undefined) {
+    bytes.push(0x03, data.adr ? 1 : 0);
+  }
+  if (data.batchMax !== undefined) {
+    bytes.push(0x04, data.batchMax);
+  }
+  if (data.display !== undefined) {
+    bytes.push(0x05, data.display ? 1 : 0);
+  }
+  if (data.diagnostics) {
+    bytes.push(0x06);
+  }
+  if (bytes.length === 0) {
+    errors.push("no command");
+  }
+
+  return {
+    bytes: bytes,
+    fPort: DOWNLINK_PORT,
+    warnings: [],
+    errors: errors
+  };
+}
@@ -0,0 +1,7 @@
+#!/bin/sh
+cd ..
+
+docker run -it --rm \
+  -v `pwd`:/workdir \
+  --name platformio-esp32 platformio-esp32 \
+  sh -c "/usr/local/bin/platformio run -e native && /usr/local/bin/platformio test -e native && node test/test_payload/golden.js && .pio/build/native/program 86400"
@@ -0,0 +1,113 @@
+#include "Airtime.hpp"
+
+#define BUCKET_SECONDS (AIRTIME_WINDOW_SECONDS / AIRTIME_BUCKETS)
+
+uint32_t airtimeUs(uint8_t spreadingFactor, uint32_t bandwidthHz,
+                   uint8_t codingRate, uint16_t payloadLength,
+                   bool crc, bool implicitHeader, uint16_t preambleLength)
+{
+    uint32_t symbolUs = ((uint32_t)1 << spreadingFactor) * 1000000UL / bandwidthHz;
+
+    // low data rate optimization is mandated for symbols longer than 16ms
+    int32_t de = symbolUs > 16000 ? 1 : 0;
+
+    int32_t numerator = 8 * (int32_t)payloadLength - 4 * spreadingFactor + 28 +
+                        (crc ? 16 : 0) - (implicitHeader ? 20 : 0);
+    int32_t denominator = 4 * (spreadingFactor - 2 * de);
+    int32_t payloadSymbols = 8;
+    if (numerator > 0)
+    {
+        payloadSymbols += ((numerator + denominator - 1) / denominator) * (codingRate + 4);
+    }
+
+    // preamble + 4.25 symbols sync word
+    uint32_t preambleUs = (4 * (uint32_t)preambleLength + 17) * symbolUs / 4;
+
+    return preambleUs + payloadSymbols * symbolUs;
+}
+
+void AirtimeBudget::begin(uint32_t budgetMs)
+{
+    budgetUs = budgetMs * 1000;
+}
+
+void AirtimeBudget::advance(uint32_t now)
+{
+    uint32_t current = now / BUCKET_SECONDS;
+
+    if (current - hour >= AIRTIME_BUCKETS)
+    {
+        for (int i = 0; i < AIRTIME_BUCKETS; i++)
+        {
+            buckets[i] = 0;
+        }
+    }
+    else
+    {
+        while (hour != current)
+        {
+            hour++;
+            buckets[hour % AIRTIME_BUCKETS] = 0;
+        }
+    }
+    hour = current;
+}
+
+void AirtimeBudget::record(uint32_t now, uint32_t airtimeUs)
+{
+    advance(now);
+    buckets[hour % AIRTIME_BUCKETS] += airtimeUs;
+}
+
+uint32_t AirtimeBudget::usedUs(uint32_t now)
+{
+    advance(now);
+
+    uint32_t used = 0;
+    for (int i = 0; i < AIRTIME_BUCKETS; i++)
+    {
+        used += buckets[i];
+    }
+    return used;
+}
+
+uint32_t AirtimeBudget::usedMs(uint32_t now)
+{
+    return usedUs(now) / 1000;
+}
+
+uint32_t AirtimeBudget::nextInterval(uint32_t now, uint32_t airtimeUs, uint32_t minInterval)
+{
+    if (budgetUs == 0 || airtimeUs == 0)
+    {
+        return minInterval;
+    }
+
+    // spread the budget evenly over the window, this stretches the
+    // interval at slow data rates and compresses it again at fast ones
+    uint32_t interval = (uint64_t)airtimeUs * AIRTIME_WINDOW_SECONDS / budgetUs;
+    if (interval < minInterval)
+    {
+        interval = minInterval;
+    }
+
+    // budget exhausted, wait until enough old buckets leave the window
+    uint32_t used = usedUs(now);
+    if (used + airtimeUs > budgetUs)
+    {
+        uint32_t wait = 0;
+        for (int i = 1; i <= AIRTIME_BUCKETS && used + airtimeUs > budgetUs; i++)
+        {
+            // the oldest bucket expires first, never below zero
+            uint32_t expired = buckets[(hour + i) % AIRTIME_BUCKETS];
+            used -= expired < used ? expired : used;
+            wait = (hour + i) * BUCKET_SECONDS - now;
+        }
+        if (wait > interval)
+        {
+            interval = wait;
+        }
+    }
+
+    return interval;
+}
@@ -0,0 +1,45 @@
+#ifndef __AIRTIME_H__
+#define __AIRTIME_H__
+
+#include <stdint.h>
+
+// LoRaWAN MHDR + FHDR (without FOpts) + FPort + MIC
+#define LORAWAN_FRAME_OVERHEAD 13
+
+#define AIRTIME_WINDOW_SECONDS 86400
+#define AIRTIME_BUCKETS 24
+
+/*
+ * LoRa time on air in microseconds, Semtech AN1200.13.
+ * codingRate 1..4 for 4/5..4/8, payloadLength is the PHY payload.
+ */
+extern uint32_t airtimeUs(uint8_t spreadingFactor, uint32_t bandwidthHz,
+                          uint8_t codingRate, uint16_t payloadLength,
+                          bool crc = true, bool implicitHeader = false,
+                          uint16_t preambleLength = 8);
+
+/*
+ * Rolling 24 hour airtime ledger with one hour buckets.
+ * Times are seconds of a clock that keeps running through deep sleep.
+ */
+class AirtimeBudget
+{
+public:
+  void begin(uint32_t budgetMs);
+
+  void record(uint32_t now, uint32_t airtimeUs);
+  uint32_t usedMs(uint32_t now);
+
+  // seconds until the next uplink of the given airtime may start
+  uint32_t nextInterval(uint32_t now, uint32_t airtimeUs, uint32_t minInterval);
+
+private:
+  void advance(uint32_t now);
+  uint32_t usedUs(uint32_t now);
+
+  uint32_t budgetUs;
+  uint32_t hour;
+  uint32_t buckets[AIRTIME_BUCKETS]; // airtime in us
+};
+
+#endif
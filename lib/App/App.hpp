@@ -2,6 +2,7 @@
 #define __APP_HPP__
 
 #include <AppConfig.h>
+#include <BinLog.hpp>
 
 #define LOG0( format ) Serial.printf( "(%lu) " format, millis())
 #define LOG1( format, x) Serial.printf( "(%lu) " format, millis(), x )
@@ -30,12 +31,18 @@
 #define SERIAL_PRINTB( value, base ) Serial.print( value, base )
 #define SERIAL_PRINTLN( value ) Serial.println( value )
 #define SERIAL_PRINTLNB( value, base ) Serial.println( value, base )
+#ifdef BINLOG_ENABLED
+#define BINLOG( id, ... ) binLog.log( BINLOG_##id, ##__VA_ARGS__ )
+#else
+#define BINLOG( id, ... ) Serial.printf( binLogFormats[BINLOG_##id], ##__VA_ARGS__ )
+#endif
 #else
 #define SERIAL_PRINT( value )
 #define SERIAL_PRINTF( format, ... )
 #define SERIAL_PRINTB( value, base )
 #define SERIAL_PRINTLN( value )
 #define SERIAL_PRINTLNB( value, base )
+#define BINLOG( id, ... )
 #endif
 
 #ifdef DISPLAY_ENABLED
@@ -0,0 +1,149 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include "Backlog.hpp"
+
+#define BACKLOG_FIRST_KEY "first"
+#define BACKLOG_COUNT_KEY "count"
+
+RTC_DATA_ATTR Backlog backlog;
+
+static Preferences preferences;
+static bool preferencesOpen = false;
+
+static Preferences &openPreferences()
+{
+    if (!preferencesOpen)
+    {
+        preferencesOpen = preferences.begin(BACKLOG_PREFERENCE_NAME);
+    }
+    return preferences;
+}
+
+static void slotKey(uint16_t slot, char *key, size_t size)
+{
+    snprintf(key, size, "e%u", slot);
+}
+
+void Backlog::begin(BacklogPolicy policy)
+{
+    this->policy = policy;
+    if (valid)
+    {
+        return;
+    }
+
+    Preferences &preferences = openPreferences();
+    flashFirst = preferences.getUInt(BACKLOG_FIRST_KEY, 0);
+    flashCount = preferences.getUInt(BACKLOG_COUNT_KEY, 0);
+    if (flashFirst >= BACKLOG_FLASH_ENTRIES || flashCount > BACKLOG_FLASH_ENTRIES)
+    {
+        flashFirst = 0;
+        flashCount = 0;
+    }
+    rtcFirst = 0;
+    rtcCount = 0;
+    valid = true;
+}
+
+void Backlog::push(uint32_t now, const uint8_t *data, uint8_t length)
+{
+    if (length > BACKLOG_PAYLOAD_SIZE)
+    {
+        length = BACKLOG_PAYLOAD_SIZE;
+    }
+    if (rtcCount == BACKLOG_RTC_ENTRIES)
+    {
+        spill();
+    }
+
+    BacklogEntry &entry = entries[(rtcFirst + rtcCount) % BACKLOG_RTC_ENTRIES];
+    memset(&entry, 0, sizeof(entry));
+    entry.storedAt = now;
+    entry.length = length;
+    memcpy(entry.data, data, length);
+    rtcCount++;
+    statistics.stored++;
+}
+
+// the oldest RTC entry becomes the newest flash entry
+void Backlog::spill()
+{
+    if (flashCount == BACKLOG_FLASH_ENTRIES)
+    {
+        flashFirst = (flashFirst + 1) % BACKLOG_FLASH_ENTRIES;
+        flashCount--;
+        statistics.dropped++;
+    }
+
+    char key[8];
+    slotKey((flashFirst + flashCount) % BACKLOG_FLASH_ENTRIES, key, sizeof(key));
+    openPreferences().putBytes(key, &entries[rtcFirst], sizeof(BacklogEntry));
+    flashCount++;
+    storeFlashRing();
+
+    rtcFirst = (rtcFirst + 1) % BACKLOG_RTC_ENTRIES;
+    rtcCount--;
+    statistics.spilled++;
+}
+
+bool Backlog::readFlash(uint16_t slot, BacklogEntry &entry)
+{
+    char key[8];
+    slotKey(slot, key, sizeof(key));
+    return openPreferences().getBytes(key, &entry, sizeof(entry)) == sizeof(entry) &&
+           entry.length <= BACKLOG_PAYLOAD_SIZE;
+}
+
+void Backlog::storeFlashRing()
+{
+    Preferences &preferences = openPreferences();
+    preferences.putUInt(BACKLOG_FIRST_KEY, flashFirst);
+    preferences.putUInt(BACKLOG_COUNT_KEY, flashCount);
+}
+
+bool Backlog::pop(uint32_t now, BacklogEntry &entry)
+{
+    // flash holds the older payloads, RTC memory the newer ones
+    bool found = false;
+    while (!found && !empty())
+    {
+        if (policy == BACKLOG_NEWEST_FIRST ? rtcCount > 0 : flashCount == 0)
+        {
+            uint8_t slot = policy == BACKLOG_NEWEST_FIRST ? (rtcFirst + rtcCount - 1) % BACKLOG_RTC_ENTRIES : rtcFirst;
+            entry = entries[slot];
+            if (policy == BACKLOG_OLDEST_FIRST)
+            {
+                rtcFirst = (rtcFirst + 1) % BACKLOG_RTC_ENTRIES;
+            }
+            rtcCount--;
+            found = true;
+        }
+        else
+        {
+            uint16_t slot = policy == BACKLOG_NEWEST_FIRST ? (flashFirst + flashCount - 1) % BACKLOG_FLASH_ENTRIES : flashFirst;
+            // a damaged record is skipped
+            found = readFlash(slot, entry);
+            if (policy == BACKLOG_OLDEST_FIRST)
+            {
+                flashFirst = (flashFirst + 1) % BACKLOG_FLASH_ENTRIES;
+            }
+            flashCount--;
+            storeFlashRing();
+        }
+    }
+
+    if (!found)
+    {
+        return false;
+    }
+
+    uint32_t wait = now > entry.storedAt ? now - entry.storedAt : 0;
+    statistics.drained++;
+    statistics.lastWait = wait;
+    statistics.sumWait += wait;
+    if (wait > statistics.maxWait)
+    {
+        statistics.maxWait = wait;
+    }
+    return true;
+}
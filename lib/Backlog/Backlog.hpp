@@ -0,0 +1,85 @@
+#ifndef __BACKLOG_H__
+#define __BACKLOG_H__
+
+#include <stdint.h>
+
+// payloads kept in RTC memory, about 70 bytes each
+#ifndef BACKLOG_RTC_ENTRIES
+#define BACKLOG_RTC_ENTRIES 16
+#endif
+
+// payloads kept in NVS once the RTC ring is full, then the oldest is dropped
+#ifndef BACKLOG_FLASH_ENTRIES
+#define BACKLOG_FLASH_ENTRIES 64
+#endif
+
+#define BACKLOG_PAYLOAD_SIZE 64
+#define BACKLOG_PREFERENCE_NAME "backlog"
+
+enum BacklogPolicy : uint8_t
+{
+  BACKLOG_OLDEST_FIRST,
+  BACKLOG_NEWEST_FIRST
+};
+
+struct BacklogEntry
+{
+  uint32_t storedAt; // seconds
+  uint8_t length;
+  uint8_t data[BACKLOG_PAYLOAD_SIZE];
+};
+
+struct BacklogStatistics
+{
+  uint32_t stored;
+  uint32_t spilled; // moved from RTC memory to flash
+  uint32_t dropped; // oldest payload lost, flash was full
+  uint32_t drained;
+  uint32_t lastWait; // seconds from push to pop
+  uint32_t maxWait;
+  uint64_t sumWait;
+};
+
+/*
+ * Payloads that could not be delivered while the link was down. A ring
+ * in RTC memory survives deep sleep; when it is full its oldest payload
+ * moves to a ring in NVS, which also survives a power loss. Flash is
+ * only written while the RTC ring overflows.
+ *
+ * Times are seconds of a clock that keeps running through deep sleep.
+ * It restarts after a power loss, waits are not counted across one.
+ */
+class Backlog
+{
+public:
+  // after a cold boot the RTC ring is empty, the flash ring is read back
+  void begin(BacklogPolicy policy);
+
+  void push(uint32_t now, const uint8_t *data, uint8_t length);
+  // next payload by policy and how long it waited, false if none is left
+  bool pop(uint32_t now, BacklogEntry &entry);
+
+  uint16_t count() const { return rtcCount + flashCount; }
+  bool empty() const { return count() == 0; }
+  uint16_t getFlashCount() const { return flashCount; }
+  const BacklogStatistics &getStatistics() const { return statistics; }
+
+private:
+  void spill();
+  bool readFlash(uint16_t slot, BacklogEntry &entry);
+  void storeFlashRing();
+
+  bool valid;
+  BacklogPolicy policy;
+  BacklogEntry entries[BACKLOG_RTC_ENTRIES];
+  uint8_t rtcFirst;
+  uint8_t rtcCount;
+  // copy of the NVS ring position
+  uint16_t flashFirst;
+  uint16_t flashCount;
+  BacklogStatistics statistics;
+};
+
+extern Backlog backlog;
+
+#endif
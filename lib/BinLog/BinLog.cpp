@@ -0,0 +1,134 @@
+#include <Arduino.h>
+#include "BinLog.hpp"
+
+static_assert((BINLOG_BUFFER_SIZE & (BINLOG_BUFFER_SIZE - 1)) == 0,
+              "BINLOG_BUFFER_SIZE must be a power of two");
+
+BinLog binLog;
+
+const char *const binLogFormats[] = {BINLOG_FORMATS(BINLOG_FORMAT_STRING)};
+
+void BinLog::write(BinLogFormatId id, const uint32_t *args, uint8_t argc)
+{
+    uint32_t start = ESP.getCycleCount();
+
+    if (argc > BINLOG_MAX_ARGS)
+    {
+        argc = BINLOG_MAX_ARGS;
+    }
+
+    BinLogHeader header;
+    header.sync = BINLOG_SYNC;
+    header.id = id;
+    header.argc = argc;
+    header.check = id ^ argc ^ BINLOG_SYNC;
+    header.timestamp = micros();
+
+    size_t length = sizeof(header) + argc * sizeof(uint32_t);
+    if (BINLOG_BUFFER_SIZE - (head - tail) < length)
+    {
+        statistics.dropped++;
+    }
+    else
+    {
+        const uint8_t *data = (const uint8_t *)&header;
+        for (size_t i = 0; i < sizeof(header); i++)
+        {
+            buffer[head++ & (BINLOG_BUFFER_SIZE - 1)] = data[i];
+        }
+        data = (const uint8_t *)args;
+        for (size_t i = 0; i < argc * sizeof(uint32_t); i++)
+        {
+            buffer[head++ & (BINLOG_BUFFER_SIZE - 1)] = data[i];
+        }
+        statistics.written++;
+    }
+
+    if (measuring)
+    {
+        statistics.windowCycles += ESP.getCycleCount() - start;
+    }
+}
+
+void BinLog::read(uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        data[i] = buffer[tail++ & (BINLOG_BUFFER_SIZE - 1)];
+    }
+}
+
+size_t BinLog::peekLength()
+{
+    uint8_t argc = buffer[(tail + 2) & (BINLOG_BUFFER_SIZE - 1)];
+    return sizeof(BinLogHeader) + argc * sizeof(uint32_t);
+}
+
+bool BinLog::printRecord(bool blocking)
+{
+    if (empty())
+    {
+        return false;
+    }
+
+#ifdef BINLOG_RAW_OUTPUT
+    // raw records, decode the capture with tools/binlog_decode
+    size_t length = peekLength();
+    if (!blocking && (size_t)Serial.availableForWrite() < length)
+    {
+        return false;
+    }
+    uint8_t record[sizeof(BinLogHeader) + BINLOG_MAX_ARGS * sizeof(uint32_t)];
+    read(record, length);
+    Serial.write(record, length);
+#else
+    BinLogHeader header;
+    uint32_t args[BINLOG_MAX_ARGS] = {0};
+    char text[128];
+
+    // the formatted text is not known before reading the record,
+    // just make sure a typical line fits
+    if (!blocking && Serial.availableForWrite() < 64)
+    {
+        return false;
+    }
+
+    read((uint8_t *)&header, sizeof(header));
+    read((uint8_t *)args, header.argc * sizeof(uint32_t));
+
+    if (header.id >= BINLOG_FORMAT_COUNT)
+    {
+        return true;
+    }
+
+    snprintf(text, sizeof(text), binLogFormats[header.id],
+             args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]);
+    Serial.print(text);
+#endif
+    return true;
+}
+
+void BinLog::drain()
+{
+    while (printRecord(false))
+        ;
+}
+
+void BinLog::flush()
+{
+    while (printRecord(true))
+        ;
+    Serial.flush();
+}
+
+void BinLog::beginWindow()
+{
+    statistics.windowCycles = 0;
+    measuring = true;
+}
+
+uint32_t BinLog::endWindow()
+{
+    measuring = false;
+    return statistics.windowCycles;
+}
@@ -0,0 +1,57 @@
+#ifndef __BINLOG_H__
+#define __BINLOG_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "BinLogFormats.h"
+
+#ifndef BINLOG_BUFFER_SIZE
+#define BINLOG_BUFFER_SIZE 2048
+#endif
+
+struct BinLogStatistics
+{
+  uint32_t written;
+  uint32_t dropped;
+  uint32_t windowCycles; // cycles spent in log() between beginWindow() and endWindow()
+};
+
+class BinLog
+{
+public:
+  template <typename... Args>
+  void log(BinLogFormatId id, Args... args)
+  {
+    uint32_t values[sizeof...(args) + 1] = {(uint32_t)args..., 0};
+    write(id, values, sizeof...(args));
+  }
+
+  void write(BinLogFormatId id, const uint32_t *args, uint8_t argc);
+
+  // format and print as much as the serial TX buffer takes without blocking
+  void drain();
+  // print everything, blocks
+  void flush();
+
+  void beginWindow();
+  uint32_t endWindow();
+
+  bool empty() const { return head == tail; }
+  const BinLogStatistics &getStatistics() const { return statistics; }
+
+private:
+  bool printRecord(bool blocking);
+  void read(uint8_t *data, size_t length);
+  size_t peekLength();
+
+  uint8_t buffer[BINLOG_BUFFER_SIZE];
+  size_t head = 0;
+  size_t tail = 0;
+  bool measuring = false;
+  BinLogStatistics statistics = {};
+};
+
+extern BinLog binLog;
+extern const char *const binLogFormats[];
+
+#endif
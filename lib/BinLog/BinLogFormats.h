@@ -0,0 +1,88 @@
+#ifndef __BINLOG_FORMATS_H__
+#define __BINLOG_FORMATS_H__
+
+#include <stdint.h>
+
+/*
+ * Format strings of all binary log records. A record only carries the
+ * index into this table and the raw 32 bit arguments. The table is
+ * shared with tools/binlog_decode, append new formats at the end to
+ * keep old captures readable. Only 32 bit integer conversions
+ * (%d, %u, %X, %02X, ...) are allowed.
+ */
+#define BINLOG_FORMATS(X)                                                                 \
+  X(EV_SCAN_TIMEOUT, "%d: EV_SCAN_TIMEOUT\n")                                             \
+  X(EV_BEACON_FOUND, "%d: EV_BEACON_FOUND\n")                                             \
+  X(EV_BEACON_MISSED, "%d: EV_BEACON_MISSED\n")                                           \
+  X(EV_BEACON_TRACKED, "%d: EV_BEACON_TRACKED\n")                                         \
+  X(EV_JOINING, "%d: EV_JOINING\n")                                                       \
+  X(EV_JOINED, "%d: EV_JOINED\n")                                                         \
+  X(JOINED_NETID, "netid: %u\n")                                                          \
+  X(JOINED_DEVADDR, "devaddr: %X\n")                                                      \
+  X(JOINED_APPSKEY, "AppSKey: %02X-%02X-%02X-%02X-%02X-%02X-%02X-%02X")                   \
+  X(JOINED_NWKSKEY, "NwkSKey: %02X-%02X-%02X-%02X-%02X-%02X-%02X-%02X")                   \
+  X(JOINED_KEY_END, "-%02X-%02X-%02X-%02X-%02X-%02X-%02X-%02X\n")                         \
+  X(EV_JOIN_FAILED, "%d: EV_JOIN_FAILED\n")                                               \
+  X(EV_REJOIN_FAILED, "%d: EV_REJOIN_FAILED\n")                                           \
+  X(EV_TXCOMPLETE, "%d: EV_TXCOMPLETE (includes waiting for RX windows)\n")               \
+  X(RECEIVED_ACK, "Received ack\n")                                                       \
+  X(LINK_STATUS, "RSSI: %d\nSNR: %d\nSF: %d\n")                                           \
+  X(BANDWIDTH, "BW: %d\n")                                                                \
+  X(SEQUENCE_STORED, "TXC sequence=%u\n")                                                 \
+  X(EV_LOST_TSYNC, "%d: EV_LOST_TSYNC\n")                                                 \
+  X(EV_RESET, "%d: EV_RESET\n")                                                           \
+  X(EV_RXCOMPLETE, "%d: EV_RXCOMPLETE\n")                                                 \
+  X(EV_LINK_DEAD, "%d: EV_LINK_DEAD\n")                                                   \
+  X(EV_LINK_ALIVE, "%d: EV_LINK_ALIVE\n")                                                 \
+  X(EV_TXSTART, "%d: EV_TXSTART\n")                                                       \
+  X(EV_TXCANCELED, "%d: EV_TXCANCELED\n")                                                 \
+  X(EV_JOIN_TXCOMPLETE, "%d: EV_JOIN_TXCOMPLETE: no JoinAccept\n")                        \
+  X(EV_UNKNOWN, "%d: Unknown event: %u\n")                                                \
+  X(NOT_SENDING, "OP_TXRXPEND, not sending\n")                                            \
+  X(BATTERY, "bat=%u.%02uV\n")                                                            \
+  X(RSSI, "rssi=%d\n")                                                                    \
+  X(PACKET_QUEUED, "%u Packet queued\n")                                                  \
+  X(LOG_CYCLES, "binlog: %u cycles between EV_TXSTART and EV_TXCOMPLETE, %u dropped\n") \
+  X(CYCLE_TIME, "cycle: %u ms wall time, %u ms awake\n")                                 \
+  X(AIRTIME, "airtime: %u ms, %u ms used in 24h, next uplink in %u s\n")                 \
+  X(LINK_ADR, "link adr: SF%u -> SF%u, %d dBm, margin %d dB\n")                      \
+  X(SESSION_SAVED, "session saved: devaddr %X, %u joins\n")                              \
+  X(SESSION_RESTORED, "session restored: devaddr %X, sequence %u, from flash %u\n")       \
+  X(FIRST_TX, "first tx: %u ms after start, warm wake %u\n")                           \
+  X(RX_TIMING, "rx timing: window %u, tx done %u us, scheduled %u us, opened %u us, dio0 %u us, dio1 %u us\n") \
+  X(RX_JITTER, "rx jitter: rx1 %d us, rx2 %d us late at most, clock error %u/65536\n")    \
+  X(HANDLER_PROFILE, "handler profile: slowest event %u, max %u cycles, mean %u cycles\n") \
+  X(DOWNLINK, "downlink: status %u, changed %X, at byte %u\n")                           \
+  X(DIAGNOSTICS_QUEUED, "diagnostics queued, %u bytes\n")                                 \
+  X(UPLINK_QUEUED, "uplink queued: port %u, %u bytes, confirmed %u\n")                     \
+  X(UPLINK_SENT, "uplink stream %u: queued %u s, max %u s\n")                            \
+  X(LINK_STATE, "link down %u, %u missed acks, %u payloads in backlog\n")                 \
+  X(BACKLOG_STORED, "backlog: %u payloads, %u in flash, %u dropped\n")                    \
+  X(BACKLOG_DRAINED, "backlog: payload waited %u s, %u left, sent within %u s\n")       \
+  X(CONFIRMED, "confirmed uplink: result %u, ack rate %u %%, retry in %u s\n")            \
+  X(LINK_STATS, "link stats: %u uplinks, %u downlinks, rssi %d dBm, snr %d dB, ack %u %%, airtime %u ms\n") \
+  X(UPLINK_DEFERRED, "uplink stream %u: larger than %u bytes, deferred %u times\n")
+
+#define BINLOG_FORMAT_ID(name, format) BINLOG_##name,
+#define BINLOG_FORMAT_STRING(name, format) format,
+
+enum BinLogFormatId : uint8_t
+{
+  BINLOG_FORMATS(BINLOG_FORMAT_ID)
+  BINLOG_FORMAT_COUNT
+};
+
+#define BINLOG_MAX_ARGS 8
+#define BINLOG_SYNC 0xA5
+
+// Record layout, little endian, followed by argc 32 bit arguments
+struct BinLogHeader
+{
+  uint8_t sync;
+  uint8_t id;
+  uint8_t argc;
+  uint8_t check; // id ^ argc ^ BINLOG_SYNC
+  uint32_t timestamp; // micros()
+};
+
+#endif
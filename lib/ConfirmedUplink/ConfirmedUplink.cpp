@@ -0,0 +1,62 @@
+#include "ConfirmedUplink.hpp"
+
+void ConfirmedUplink::begin(uint8_t every)
+{
+    this->every = every;
+    if (!valid)
+    {
+        // nothing missed yet
+        ackRate = 0x10000;
+        valid = true;
+    }
+}
+
+bool ConfirmedUplink::request(bool critical)
+{
+    bool periodic = false;
+    if (every > 0)
+    {
+        counter = (counter + 1) % every;
+        periodic = counter == 0;
+    }
+
+    // counted when the uplink completes, it may still be canceled
+    requested = critical || periodic || attempts > 0;
+    return requested;
+}
+
+ConfirmedResult ConfirmedUplink::completed(bool acked, uint32_t &backoff)
+{
+    if (!requested)
+    {
+        return CONFIRMED_NONE;
+    }
+    requested = false;
+    statistics.requested++;
+
+    uint32_t sample = acked ? 0x10000 : 0;
+    ackRate = ackRate - (ackRate >> CONFIRMED_ACK_RATE_SHIFT) + (sample >> CONFIRMED_ACK_RATE_SHIFT);
+
+    if (acked)
+    {
+        statistics.acked++;
+        attempts = 0;
+        return CONFIRMED_ACKED;
+    }
+
+    if (attempts >= CONFIRMED_RETRIES)
+    {
+        statistics.givenUp++;
+        attempts = 0;
+        return CONFIRMED_GIVE_UP;
+    }
+
+    backoff = (uint32_t)CONFIRMED_BACKOFF << attempts;
+    if (backoff > CONFIRMED_BACKOFF_MAX)
+    {
+        backoff = CONFIRMED_BACKOFF_MAX;
+    }
+    attempts++;
+    statistics.retransmitted++;
+    return CONFIRMED_RETRY;
+}
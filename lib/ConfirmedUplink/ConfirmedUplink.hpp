@@ -0,0 +1,81 @@
+#ifndef __CONFIRMED_UPLINK_H__
+#define __CONFIRMED_UPLINK_H__
+
+#include <stdint.h>
+
+// every n-th uplink asks for an ack, 0 = only critical ones
+#ifndef CONFIRMED_EVERY
+#define CONFIRMED_EVERY 0
+#endif
+
+// retransmissions of an unacknowledged uplink before it is given up
+#ifndef CONFIRMED_RETRIES
+#define CONFIRMED_RETRIES 3
+#endif
+
+// seconds before the first retransmission, doubled for each further one
+#ifndef CONFIRMED_BACKOFF
+#define CONFIRMED_BACKOFF 30
+#endif
+
+#ifndef CONFIRMED_BACKOFF_MAX
+#define CONFIRMED_BACKOFF_MAX 960
+#endif
+
+// 1/8 of the ack rate follows each confirmed uplink
+#define CONFIRMED_ACK_RATE_SHIFT 3
+
+enum ConfirmedResult : uint8_t
+{
+  CONFIRMED_NONE, // no ack was requested
+  CONFIRMED_ACKED,
+  CONFIRMED_RETRY,  // send the same payloads again after the backoff
+  CONFIRMED_GIVE_UP // no ack after CONFIRMED_RETRIES retransmissions
+};
+
+struct ConfirmedStatistics
+{
+  uint32_t requested;
+  uint32_t acked;
+  uint32_t retransmitted;
+  uint32_t givenUp;
+};
+
+/*
+ * Which uplinks ask for an ack and what happens if none arrives. LMIC
+ * repeats an unacknowledged confirmed frame itself before it reports
+ * TXRX_NACK; after that the payloads are sent again, each time with
+ * twice the backoff, and finally given up.
+ *
+ * Plain C++, the object can live in RTC memory.
+ */
+class ConfirmedUplink
+{
+public:
+  // keeps counters and statistics over deep sleep
+  void begin(uint8_t every);
+
+  // whether the next uplink asks for an ack; critical ones and
+  // retransmissions always do
+  bool request(bool critical);
+
+  // EV_TXCOMPLETE of the uplink, backoff in seconds for CONFIRMED_RETRY
+  ConfirmedResult completed(bool acked, uint32_t &backoff);
+
+  bool isRequested() const { return requested; }
+  uint8_t getAttempts() const { return attempts; }
+  // acked share of the recent confirmed uplinks, percent
+  uint8_t getAckRate() const { return (ackRate * 100 + 0x8000) >> 16; }
+  const ConfirmedStatistics &getStatistics() const { return statistics; }
+
+private:
+  bool valid;
+  uint8_t every;
+  uint8_t counter;
+  bool requested;
+  uint8_t attempts; // failed ones of the current payloads
+  uint32_t ackRate; // 1/65536
+  ConfirmedStatistics statistics;
+};
+
+#endif
@@ -1,10 +1,31 @@
 #include <Arduino.h>
 #include <App.hpp>
+#include <RenderPipeline.hpp>
+#include <LinkStats.hpp>
 #include "DisplayHandler.hpp"
 
 SSD1306Wire display(0x3c, OLED_SDA, OLED_SCL, OLED_RST, GEOMETRY_128_64);
 DisplayHandler displayHandler;
 
+// last snapshot drawn by the render task
+static StatusSnapshot shown;
+static bool shownValid = false;
+
+// an identical snapshot right after the last one draws the same pixels
+static bool unchanged(const StatusSnapshot &snapshot)
+{
+    bool same = shownValid && snapshot.kind == shown.kind &&
+                snapshot.kind != SNAPSHOT_LINK_STATS && // read live from LinkStats
+                !strcmp(snapshot.text, shown.text) &&
+                snapshot.txCounter == shown.txCounter && snapshot.rxCounter == shown.rxCounter &&
+                snapshot.freq == shown.freq && snapshot.bandwidth == shown.bandwidth &&
+                snapshot.batteryMv == shown.batteryMv && snapshot.rssi == shown.rssi &&
+                snapshot.snr == shown.snr && snapshot.sf == shown.sf && snapshot.dataLen == shown.dataLen;
+    shown = snapshot;
+    shownValid = true;
+    return same;
+}
+
 void DisplayHandler::setup()
 {
     display.init();
@@ -21,25 +42,184 @@ void DisplayHandler::setup()
     display.drawString(0, 36, "Build Date: " __DATE__);
     display.drawString(0, 48, "Build Time: " __TIME__);
     display.display();
+
+    // from now on the display belongs to the render task
+    shownValid = false;
+    renderPipeline.begin(DisplayHandler::render);
+    active = true;
 #else
     display.displayOff();
 #endif
 }
 
+void DisplayHandler::sleep()
+{
+    if (!active)
+    {
+        return;
+    }
+    renderPipeline.end();
+    display.displayOff();
+    active = false;
+}
+
+void DisplayHandler::clear()
+{
+    if (!active)
+    {
+        return;
+    }
+    StatusSnapshot snapshot = {};
+    snapshot.kind = SNAPSHOT_CLEAR;
+    invalidate(snapshot);
+}
+
 void DisplayHandler::printStatus(const char *status)
 {
-    display.setColor(BLACK);
-    display.fillRect(0, 0, 128, 12);
-    display.setColor(WHITE);
-    display.drawString(0, 0, status);
-    display.display();
+    if (!active)
+    {
+        return;
+    }
+    StatusSnapshot snapshot = {};
+    snapshot.kind = SNAPSHOT_STATUS;
+    strncpy(snapshot.text, status, sizeof(snapshot.text) - 1);
+    invalidate(snapshot);
 }
 
 void DisplayHandler::printError(const char *error)
 {
-    display.setColor(BLACK);
-    display.fillRect(0, 48, 128, 16);
-    display.setColor(WHITE);
-    display.drawString(0, 48, error);
+    if (!active)
+    {
+        return;
+    }
+    StatusSnapshot snapshot = {};
+    snapshot.kind = SNAPSHOT_ERROR;
+    strncpy(snapshot.text, error, sizeof(snapshot.text) - 1);
+    invalidate(snapshot);
+}
+
+void DisplayHandler::show(StatusSnapshot &snapshot)
+{
+    if (!active)
+    {
+        return;
+    }
+    invalidate(snapshot);
+}
+
+void DisplayHandler::invalidate(const StatusSnapshot &snapshot)
+{
+    if (!active)
+    {
+        return;
+    }
+    renderPipeline.invalidate(snapshot);
+}
+
+void DisplayHandler::update()
+{
+    if (!active)
+    {
+        return;
+    }
+    renderPipeline.update();
+}
+
+uint32_t DisplayHandler::timeUntilNextUpdate() const
+{
+    return active ? renderPipeline.timeUntilNextUpdate() : RENDER_NO_DEADLINE;
+}
+
+void DisplayHandler::render(const StatusSnapshot &snapshot)
+{
+    char buf[32];
+
+    // repeated status lines cost neither drawing nor an I2C transfer
+    if (unchanged(snapshot))
+    {
+        return;
+    }
+
+    switch (snapshot.kind)
+    {
+    case SNAPSHOT_CLEAR:
+        display.clear();
+        break;
+
+    case SNAPSHOT_STATUS:
+        display.setColor(BLACK);
+        display.fillRect(0, 0, 128, 12);
+        display.setColor(WHITE);
+        display.drawString(0, 0, snapshot.text);
+        break;
+
+    case SNAPSHOT_ERROR:
+        display.setColor(BLACK);
+        display.fillRect(0, 48, 128, 16);
+        display.setColor(WHITE);
+        display.drawString(0, 48, snapshot.text);
+        break;
+
+    case SNAPSHOT_JOINED:
+        display.drawString(0, 12, "JOINED");
+        break;
+
+    case SNAPSHOT_TXCOMPLETE:
+        display.clear();
+        display.drawString(0, 0, "TXCOMPLETE");
+        sprintf(buf, "TXC: %u", snapshot.txCounter);
+        display.drawString(0, 12, buf);
+        sprintf(buf, "RXC: %u (%d)", snapshot.rxCounter, snapshot.dataLen);
+        display.drawString(52, 12, buf);
+        sprintf(buf, "RSSI: %d", snapshot.rssi);
+        display.drawString(0, 24, buf);
+        if (snapshot.batteryMv > 0)
+        {
+            sprintf(buf, "BAT: %.02fV", snapshot.batteryMv / 1000.0);
+            display.drawString(52, 24, buf);
+        }
+        sprintf(buf, "SNR: %d", snapshot.snr);
+        display.drawString(0, 36, buf);
+        sprintf(buf, "SF: %u", snapshot.sf);
+        display.drawString(52, 36, buf);
+        sprintf(buf, "BW: %u", snapshot.bandwidth);
+        display.drawString(88, 36, buf);
+        sprintf(buf, "FREQ: %u", snapshot.freq);
+        display.drawString(0, 48, buf);
+        break;
+
+    case SNAPSHOT_LINK_STATS:
+    {
+        char lines[4][32];
+        uint32_t sequence;
+        // LMIC may complete the next uplink meanwhile, then read again
+        do
+        {
+            sequence = snapshot.linkStats->beginRead();
+            const LinkStatsSnapshot &link = snapshot.linkStats->getSnapshot();
+            uint8_t low = LinkStats::percentileBin(link.rssiBins, LINK_STATS_RSSI_BINS, 10);
+            sprintf(lines[0], "UP: %u  RX1: %u  RX2: %u", link.uplinks, link.rx1, link.rx2);
+            if (link.rx1 + link.rx2 > 0)
+            {
+                sprintf(lines[1], "RSSI: %d  P10: %d", LinkStats::meanRssi(link), LinkStats::rssiBinFloor(low));
+            }
+            else
+            {
+                strcpy(lines[1], "RSSI: no downlink");
+            }
+            sprintf(lines[2], "SNR: %d  ACK: %u%%", LinkStats::meanSnr(link), LinkStats::ackRate(link));
+            sprintf(lines[3], "AIR: %u ms  SF: %u", LinkStats::meanAirtimeUs(link) / 1000, link.last.spreadingFactor);
+        } while (!snapshot.linkStats->endRead(sequence));
+
+        display.clear();
+        display.drawString(0, 0, "LINK STATS");
+        for (uint8_t line = 0; line < 4; line++)
+        {
+            display.drawString(0, 12 + line * 12, lines[line]);
+        }
+        break;
+    }
+    }
+
     display.display();
-}
\ No newline at end of file
+}
@@ -4,14 +4,34 @@
 #include <SPI.h>
 #include <Wire.h>
 #include <SSD1306Wire.h>
+#include <RenderPipeline.hpp>
 
 class DisplayHandler
 {
 
 public:
   void setup();
+  // stop rendering and switch the panel off before deep sleep
+  void sleep();
+  // switched off, status updates are dropped
+  bool isActive() const { return active; }
+  void clear();
   void printStatus(const char *status);
   void printError(const char *error);
+  void show(StatusSnapshot &snapshot);
+
+  // the page or an overlay changed, the next update() draws it
+  void invalidate(const StatusSnapshot &snapshot);
+  // hands what was invalidated to the render task, does nothing until then; main loop
+  void update();
+  // milliseconds until update() has something to draw, RENDER_NO_DEADLINE if nothing
+  uint32_t timeUntilNextUpdate() const;
+
+  // only called by the render task, it owns the display
+  static void render(const StatusSnapshot &snapshot);
+
+private:
+  bool active = false;
 };
 
 extern DisplayHandler displayHandler;
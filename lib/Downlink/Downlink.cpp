@@ -0,0 +1,187 @@
+#include "Downlink.hpp"
+
+static DownlinkResult result(DownlinkStatus status, uint8_t changed, size_t offset)
+{
+    DownlinkResult result = {status, changed, (uint8_t)offset};
+    return result;
+}
+
+DownlinkResult downlinkApply(const uint8_t *data, size_t length, DeviceSettings &settings)
+{
+    // work on a copy, a rejected frame must not change anything
+    DeviceSettings updated = settings;
+    uint8_t changed = 0;
+    size_t pos = 0;
+
+    if (length == 0)
+    {
+        return result(DOWNLINK_EMPTY, 0, 0);
+    }
+
+    while (pos < length)
+    {
+        size_t start = pos;
+        uint8_t command = data[pos++];
+        size_t arguments;
+
+        switch (command)
+        {
+        case DOWNLINK_INTERVAL:
+        case DOWNLINK_DATA_RATE:
+            arguments = 2;
+            break;
+        case DOWNLINK_ADR:
+        case DOWNLINK_BATCH:
+        case DOWNLINK_DISPLAY:
+            arguments = 1;
+            break;
+        case DOWNLINK_DIAGNOSTICS:
+            arguments = 0;
+            break;
+        default:
+            return result(DOWNLINK_UNKNOWN_COMMAND, 0, start);
+        }
+
+        if (length - pos < arguments)
+        {
+            return result(DOWNLINK_TRUNCATED, 0, start);
+        }
+        const uint8_t *argument = data + pos;
+        pos += arguments;
+
+        switch (command)
+        {
+        case DOWNLINK_INTERVAL:
+        {
+            uint16_t interval = (argument[0] << 8) | argument[1];
+            if (interval < DOWNLINK_INTERVAL_MIN || interval > DOWNLINK_INTERVAL_MAX)
+            {
+                return result(DOWNLINK_OUT_OF_RANGE, 0, start);
+            }
+            updated.interval = interval;
+            break;
+        }
+
+        case DOWNLINK_DATA_RATE:
+        {
+            uint8_t spreadingFactor = argument[0];
+            int8_t txPower = (int8_t)argument[1];
+            if (spreadingFactor < DOWNLINK_SF_MIN || spreadingFactor > DOWNLINK_SF_MAX ||
+                txPower < DOWNLINK_TX_POWER_MIN || txPower > DOWNLINK_TX_POWER_MAX)
+            {
+                return result(DOWNLINK_OUT_OF_RANGE, 0, start);
+            }
+            updated.spreadingFactor = spreadingFactor;
+            updated.txPower = txPower;
+            break;
+        }
+
+        case DOWNLINK_ADR:
+        case DOWNLINK_DISPLAY:
+            if (argument[0] > 1)
+            {
+                return result(DOWNLINK_OUT_OF_RANGE, 0, start);
+            }
+            if (command == DOWNLINK_ADR)
+            {
+                updated.adr = argument[0];
+            }
+            else
+            {
+                updated.display = argument[0];
+            }
+            break;
+
+        case DOWNLINK_BATCH:
+            if (argument[0] < 1 || argument[0] > SAMPLE_BATCH_MAX)
+            {
+                return result(DOWNLINK_OUT_OF_RANGE, 0, start);
+            }
+            updated.batchMax = argument[0];
+            break;
+
+        case DOWNLINK_DIAGNOSTICS:
+            changed |= DOWNLINK_CHANGED_DIAGNOSTICS;
+            break;
+        }
+    }
+
+    // a setting sent again with its current value is no change
+    if (updated.interval != settings.interval)
+    {
+        changed |= DOWNLINK_CHANGED_INTERVAL;
+    }
+    if (updated.spreadingFactor != settings.spreadingFactor || updated.txPower != settings.txPower)
+    {
+        changed |= DOWNLINK_CHANGED_DATA_RATE;
+    }
+    if (updated.adr != settings.adr)
+    {
+        changed |= DOWNLINK_CHANGED_ADR;
+    }
+    if (updated.batchMax != settings.batchMax)
+    {
+        changed |= DOWNLINK_CHANGED_BATCH;
+    }
+    if (updated.display != settings.display)
+    {
+        changed |= DOWNLINK_CHANGED_DISPLAY;
+    }
+
+    settings = updated;
+    return result(DOWNLINK_OK, changed, 0);
+}
+
+size_t downlinkEncodeDiagnostics(uint8_t *buffer, size_t size, const DeviceSettings &settings,
+                                 const Diagnostics &diagnostics, const LinkStatsSnapshot &link)
+{
+    if (size < DIAGNOSTICS_SIZE)
+    {
+        return 0;
+    }
+
+    uint16_t values[] = {diagnostics.downlinksAccepted, diagnostics.downlinksRejected,
+                         diagnostics.eventsDropped, diagnostics.flashCommits,
+                         (uint16_t)diagnostics.rx1JitterUs};
+
+    buffer[0] = DIAGNOSTICS_VERSION;
+    buffer[1] = settings.interval >> 8;
+    buffer[2] = settings.interval & 0xff;
+    buffer[3] = settings.spreadingFactor;
+    buffer[4] = (uint8_t)settings.txPower;
+    buffer[5] = (settings.adr == 1 ? 0x01 : 0) | (settings.display ? 0x02 : 0);
+    buffer[6] = settings.batchMax;
+    buffer[7] = diagnostics.uptime >> 24;
+    buffer[8] = (diagnostics.uptime >> 16) & 0xff;
+    buffer[9] = (diagnostics.uptime >> 8) & 0xff;
+    buffer[10] = diagnostics.uptime & 0xff;
+
+    size_t pos = 11;
+    for (uint16_t value : values)
+    {
+        buffer[pos++] = value >> 8;
+        buffer[pos++] = value & 0xff;
+    }
+
+    int16_t rssi = LinkStats::meanRssi(link);
+    uint32_t airtimeMs = LinkStats::meanAirtimeUs(link) / 1000;
+
+    buffer[pos++] = link.uplinks;
+    buffer[pos++] = link.rx1;
+    buffer[pos++] = link.rx2;
+    buffer[pos++] = link.ackRequested;
+    buffer[pos++] = link.acked;
+    buffer[pos++] = (uint8_t)(rssi < INT8_MIN ? INT8_MIN : rssi);
+    buffer[pos++] = (uint8_t)LinkStats::meanSnr(link);
+    buffer[pos++] = airtimeMs >> 8;
+    buffer[pos++] = airtimeMs & 0xff;
+    for (uint8_t count : link.spreadingFactors)
+    {
+        buffer[pos++] = count;
+    }
+    for (uint8_t count : link.rssiBins)
+    {
+        buffer[pos++] = count;
+    }
+    return pos;
+}
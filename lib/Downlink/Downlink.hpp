@@ -0,0 +1,128 @@
+#ifndef __DOWNLINK_H__
+#define __DOWNLINK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <SampleBuffer.hpp>
+#include <LinkStats.hpp>
+
+// FPort of the downlink commands and of the diagnostics uplink
+#ifndef DOWNLINK_PORT
+#define DOWNLINK_PORT 10
+#endif
+#ifndef DIAGNOSTICS_PORT
+#define DIAGNOSTICS_PORT 11
+#endif
+
+/*
+ * Downlink commands on DOWNLINK_PORT, encoded by TTNv3/payload_formatter.js.
+ * A frame holds one or more commands, each a command byte followed by its
+ * arguments, multi byte values big endian:
+ *
+ *   0x01 interval     uint16 seconds between uplinks, 10..43200
+ *   0x02 data rate    uint8 spreading factor 7..12, int8 TX power 2..14 dBm
+ *   0x03 adr          uint8 0 = off, 1 = on
+ *   0x04 batch        uint8 readings per uplink at most, 1..SAMPLE_BATCH_MAX
+ *   0x05 display      uint8 0 = off, 1 = on
+ *   0x06 diagnostics  no arguments, the next uplink is a diagnostics frame
+ *
+ * A frame with an unknown command, a missing argument or a value out of
+ * range is rejected as a whole, none of its commands is applied.
+ */
+
+#define DOWNLINK_INTERVAL 0x01
+#define DOWNLINK_DATA_RATE 0x02
+#define DOWNLINK_ADR 0x03
+#define DOWNLINK_BATCH 0x04
+#define DOWNLINK_DISPLAY 0x05
+#define DOWNLINK_DIAGNOSTICS 0x06
+
+#define DOWNLINK_INTERVAL_MIN 10
+#define DOWNLINK_INTERVAL_MAX 43200
+#define DOWNLINK_SF_MIN 7
+#define DOWNLINK_SF_MAX 12
+#define DOWNLINK_TX_POWER_MIN 2
+#define DOWNLINK_TX_POWER_MAX 14
+
+// bits of DownlinkResult::changed
+#define DOWNLINK_CHANGED_INTERVAL 0x01
+#define DOWNLINK_CHANGED_DATA_RATE 0x02
+#define DOWNLINK_CHANGED_ADR 0x04
+#define DOWNLINK_CHANGED_BATCH 0x08
+#define DOWNLINK_CHANGED_DISPLAY 0x10
+#define DOWNLINK_CHANGED_DIAGNOSTICS 0x20
+#define DOWNLINK_CHANGED_SETTINGS 0x1f
+
+/*
+ * diagnostics uplink on DIAGNOSTICS_PORT (44 bytes, big endian):
+ *   0      version
+ *   1-2    transmit interval, seconds
+ *   3      spreading factor
+ *   4      TX power, signed dBm
+ *   5      flags, bit 0 = adr, bit 1 = display
+ *   6      readings per uplink at most
+ *   7-10   seconds since the last cold boot
+ *   11-12  downlink frames accepted
+ *   13-14  downlink frames rejected
+ *   15-16  LMIC events dropped
+ *   17-18  frame counter flash writes
+ *   19-20  RX1 window opened late at most, signed us
+ * link statistics of the last LINK_STATS_WINDOW uplinks:
+ *   21     uplinks
+ *   22     downlinks in RX1
+ *   23     downlinks in RX2
+ *   24     confirmed uplinks
+ *   25     acknowledged ones
+ *   26     mean RSSI of the downlinks, signed dBm
+ *   27     mean SNR of the downlinks, signed dB
+ *   28-29  mean airtime per uplink, ms
+ *   30-35  uplinks per spreading factor, SF7 to SF12
+ *   36-43  downlinks per 10 dB RSSI bin, below -120 dBm to -60 dBm and above
+ */
+#define DIAGNOSTICS_VERSION 2
+#define DIAGNOSTICS_SIZE 44
+
+// Settings a downlink can change, kept in RTC memory and NVS
+struct DeviceSettings
+{
+  uint16_t interval;
+  uint8_t spreadingFactor;
+  int8_t txPower;
+  uint8_t adr; // 0 = off, 1 = on
+  uint8_t batchMax;
+  uint8_t display;
+};
+
+enum DownlinkStatus : uint8_t
+{
+  DOWNLINK_OK,
+  DOWNLINK_EMPTY,
+  DOWNLINK_UNKNOWN_COMMAND,
+  DOWNLINK_TRUNCATED,
+  DOWNLINK_OUT_OF_RANGE
+};
+
+struct DownlinkResult
+{
+  DownlinkStatus status;
+  uint8_t changed; // DOWNLINK_CHANGED_*, settings only if their value differs
+  uint8_t offset;  // of the rejected command
+};
+
+struct Diagnostics
+{
+  uint32_t uptime;
+  uint16_t downlinksAccepted;
+  uint16_t downlinksRejected;
+  uint16_t eventsDropped;
+  uint16_t flashCommits;
+  int16_t rx1JitterUs;
+};
+
+// apply the commands of one frame to settings, unchanged unless DOWNLINK_OK
+extern DownlinkResult downlinkApply(const uint8_t *data, size_t length, DeviceSettings &settings);
+
+extern size_t downlinkEncodeDiagnostics(uint8_t *buffer, size_t size, const DeviceSettings &settings,
+                                        const Diagnostics &diagnostics, const LinkStatsSnapshot &link);
+
+#endif
@@ -0,0 +1,71 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include "SettingsStore.hpp"
+
+RTC_DATA_ATTR SettingsStore settingsStore;
+
+static Preferences preferences;
+static bool preferencesOpen = false;
+
+static Preferences &openPreferences()
+{
+    if (!preferencesOpen)
+    {
+        preferencesOpen = preferences.begin(SETTINGS_PREFERENCE_NAME);
+    }
+    return preferences;
+}
+
+DeviceSettings SettingsStore::defaults()
+{
+    DeviceSettings settings = {};
+    settings.interval = TRANSMIT_INTERVAL;
+    settings.spreadingFactor = 7;
+    settings.txPower = 14;
+#ifdef ADR_ENABLED
+    settings.adr = 1;
+#else
+    settings.adr = 0;
+#endif
+    settings.batchMax = SAMPLE_BATCH_MAX;
+#ifdef DISPLAY_ENABLED
+    settings.display = 1;
+#endif
+    return settings;
+}
+
+const DeviceSettings &SettingsStore::restore()
+{
+    if (!valid)
+    {
+        Preferences &preferences = openPreferences();
+        StoredSettings stored;
+
+        if (preferences.getBytesLength(SETTINGS_KEY) == sizeof(stored) &&
+            preferences.getBytes(SETTINGS_KEY, &stored, sizeof(stored)) == sizeof(stored) &&
+            stored.version == SETTINGS_VERSION)
+        {
+            settings = stored.settings;
+        }
+        else
+        {
+            settings = defaults();
+        }
+        valid = true;
+    }
+    return settings;
+}
+
+void SettingsStore::save(const DeviceSettings &settings)
+{
+    StoredSettings stored;
+
+    // zero the padding, the record is stored byte by byte
+    memset(&stored, 0, sizeof(stored));
+    stored.version = SETTINGS_VERSION;
+    stored.settings = settings;
+    openPreferences().putBytes(SETTINGS_KEY, &stored, sizeof(stored));
+
+    this->settings = settings;
+    valid = true;
+}
@@ -0,0 +1,43 @@
+#ifndef __SETTINGS_STORE_H__
+#define __SETTINGS_STORE_H__
+
+#include <stdint.h>
+#include "Downlink.hpp"
+
+#define SETTINGS_PREFERENCE_NAME "settings"
+#define SETTINGS_KEY "settings"
+
+// bump when DeviceSettings changes, older records are ignored
+#define SETTINGS_VERSION 2
+
+struct StoredSettings
+{
+  uint8_t version;
+  DeviceSettings settings;
+};
+
+/*
+ * Settings changed by downlink commands. They live in RTC memory and
+ * are written to NVS on every change, which only a downlink causes.
+ * Until the first change the build flags apply.
+ */
+class SettingsStore
+{
+public:
+  // RTC memory, after a cold boot NVS, else the defaults
+  const DeviceSettings &restore();
+  const DeviceSettings &get() const { return settings; }
+
+  // keep changed settings in RTC memory and NVS
+  void save(const DeviceSettings &settings);
+
+  static DeviceSettings defaults();
+
+private:
+  bool valid;
+  DeviceSettings settings;
+};
+
+extern SettingsStore settingsStore;
+
+#endif
@@ -0,0 +1,246 @@
+#include <stdarg.h>
+#include "Arduino.h"
+#include "SPI.h"
+#include "Preferences.h"
+#include "esp_sleep.h"
+#include "HostSim.hpp"
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+
+static uint64_t sleepTimerUs = 0;
+
+unsigned long millis()
+{
+    return hostSim.bootUs() / 1000;
+}
+
+unsigned long micros()
+{
+    // every call takes a little time, busy loops make progress
+    hostSim.advance(1);
+    return hostSim.bootUs();
+}
+
+void delay(unsigned long ms)
+{
+    hostSim.advance(ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    hostSim.advance(us);
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    hostSim.pinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    hostSim.digitalWrite(pin, value);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return hostSim.digitalRead(pin);
+}
+
+uint16_t analogRead(uint8_t pin)
+{
+    return hostSim.analogValue;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode)
+{
+    hostSim.attachInterrupt(interrupt, isr);
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+    hostSim.attachInterrupt(interrupt, nullptr);
+}
+
+void interrupts()
+{
+    hostSim.setInterruptsEnabled(true);
+}
+
+void noInterrupts()
+{
+    hostSim.setInterruptsEnabled(false);
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (n < size && write(buffer[n]))
+    {
+        n++;
+    }
+    return n;
+}
+
+size_t Print::print(long value, int base)
+{
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), base == HEX ? "%lX" : "%ld", value);
+    return write(buffer);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), base == HEX ? "%lX" : "%lu", value);
+    return write(buffer);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return write(buffer);
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char buffer[256];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, arguments);
+    va_end(arguments);
+    if (length < 0)
+    {
+        return 0;
+    }
+    return write((const uint8_t *)buffer, std::min((size_t)length, sizeof(buffer) - 1));
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush()
+{
+    fflush(stdout);
+}
+
+void EspClass::deepSleep(uint64_t us)
+{
+    throw HostSimDeepSleep{us};
+}
+
+void EspClass::restart()
+{
+    throw HostSimDeepSleep{0};
+}
+
+uint32_t EspClass::getCycleCount()
+{
+    return hostSim.bootUs() * getCpuFreqMHz();
+}
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+    return hostSim.spiTransfer(data);
+}
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+    this->name = name;
+    this->readOnly = readOnly;
+    return true;
+}
+
+bool Preferences::clear()
+{
+    std::string prefix = name + "/";
+    for (auto it = hostSim.nvs.begin(); it != hostSim.nvs.end();)
+    {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? hostSim.nvs.erase(it) : std::next(it);
+    }
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    return hostSim.nvs.erase(path(key)) > 0;
+}
+
+size_t Preferences::putUInt(const char *key, uint32_t value)
+{
+    return putBytes(key, &value, sizeof(value));
+}
+
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue)
+{
+    uint32_t value = defaultValue;
+    if (getBytesLength(key) == sizeof(value))
+    {
+        getBytes(key, &value, sizeof(value));
+    }
+    return value;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length)
+{
+    if (readOnly)
+    {
+        return 0;
+    }
+    const uint8_t *bytes = (const uint8_t *)value;
+    hostSim.nvs[path(key)].assign(bytes, bytes + length);
+    hostSim.nvsWrites++;
+    return length;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength)
+{
+    auto it = hostSim.nvs.find(path(key));
+    if (it == hostSim.nvs.end() || it->second.size() > maxLength)
+    {
+        return 0;
+    }
+    memcpy(buffer, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    auto it = hostSim.nvs.find(path(key));
+    return it == hostSim.nvs.end() ? 0 : it->second.size();
+}
+
+esp_sleep_source_t esp_sleep_get_wakeup_cause()
+{
+    return hostSim.isWarmWake() ? ESP_SLEEP_WAKEUP_TIMER : ESP_SLEEP_WAKEUP_UNDEFINED;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us)
+{
+    sleepTimerUs = us;
+    return 0;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup()
+{
+    return 0;
+}
+
+esp_err_t esp_light_sleep_start()
+{
+    hostSim.lightSleep(sleepTimerUs);
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "Arduino.h"
+#include "HostSim.hpp"
+
+HostSim hostSim;
+
+void HostSim::begin(uint8_t nss, uint8_t rst, uint8_t dio0, uint8_t dio1, uint8_t dio2)
+{
+    nssPin = nss;
+    rstPin = rst;
+    dioPins[0] = dio0;
+    dioPins[1] = dio1;
+    dioPins[2] = dio2;
+    radio.reset();
+}
+
+void HostSim::advance(uint64_t us)
+{
+    advanceTo(now + us);
+}
+
+void HostSim::advanceTo(uint64_t us)
+{
+    // stop at radio interrupts on the way, the ISR sees the right time
+    while (radio.nextEventUs() <= us && radio.nextEventUs() > now)
+    {
+        now = radio.nextEventUs();
+        radio.update(now);
+        dispatchInterrupts();
+    }
+    if (us > now)
+    {
+        now = us;
+    }
+    radio.update(now);
+    dispatchInterrupts();
+}
+
+void HostSim::lightSleep(uint64_t timerUs)
+{
+    uint64_t wakeUs = now + timerUs;
+    if (radio.nextEventUs() < wakeUs)
+    {
+        wakeUs = radio.nextEventUs();
+    }
+    advanceTo(wakeUs);
+}
+
+void HostSim::deepSleep(uint64_t sleepUs)
+{
+    now += sleepUs;
+    boot = now;
+    warmWake = true;
+}
+
+void HostSim::pinMode(uint8_t pin, uint8_t mode)
+{
+    // LMIC releases the reset line by switching it to input
+    if (pin == rstPin && mode == INPUT)
+    {
+        levels[pin] = HIGH;
+    }
+}
+
+void HostSim::digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin >= HOST_SIM_PINS)
+    {
+        return;
+    }
+    levels[pin] = value;
+
+    if (pin == nssPin)
+    {
+        radio.select(value == LOW);
+    }
+    else if (pin == rstPin && value == LOW)
+    {
+        radio.reset();
+    }
+}
+
+int HostSim::digitalRead(uint8_t pin)
+{
+    radio.update(now);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (pin == dioPins[i])
+        {
+            return radio.dio(i) ? HIGH : LOW;
+        }
+    }
+    return pin < HOST_SIM_PINS ? levels[pin] : LOW;
+}
+
+void HostSim::attachInterrupt(uint8_t pin, void (*isr)())
+{
+    if (pin < HOST_SIM_PINS)
+    {
+        isrs[pin] = isr;
+    }
+}
+
+void HostSim::setInterruptsEnabled(bool enabled)
+{
+    interruptsEnabled = enabled;
+    if (enabled)
+    {
+        dispatchInterrupts();
+    }
+}
+
+void HostSim::dispatchInterrupts()
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        bool level = radio.dio(i);
+        bool rising = level && !dioLevels[i];
+
+        if (!interruptsEnabled || inInterrupt)
+        {
+            // the edge is handled once interrupts are enabled again
+            return;
+        }
+        dioLevels[i] = level;
+
+        if (rising && dioPins[i] < HOST_SIM_PINS && isrs[dioPins[i]] != nullptr)
+        {
+            inInterrupt = true;
+            isrs[dioPins[i]]();
+            inInterrupt = false;
+        }
+    }
+}
+
+uint8_t HostSim::spiTransfer(uint8_t data)
+{
+    return radio.transfer(data, now);
+}
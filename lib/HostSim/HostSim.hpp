@@ -0,0 +1,81 @@
+#ifndef __HOST_SIM_H__
+#define __HOST_SIM_H__
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "Sx127x.hpp"
+
+#define HOST_SIM_PINS 64
+
+// thrown by ESP.deepSleep(), the host main loop wakes the firmware up again
+struct HostSimDeepSleep
+{
+  uint64_t sleepUs;
+};
+
+/*
+ * Virtual clock, GPIO, NVS and SX127x radio behind the Arduino and ESP32
+ * stand-ins of this library. Time only moves when the firmware waits
+ * (delay, busy polling) or when the host main loop skips ahead to the
+ * next LMIC job or radio interrupt, so a simulated day takes seconds.
+ *
+ * RTC_DATA_ATTR is empty on the host: all globals survive a simulated
+ * deep sleep, not only the RTC ones.
+ */
+class HostSim
+{
+public:
+  void begin(uint8_t nss, uint8_t rst, uint8_t dio0, uint8_t dio1, uint8_t dio2);
+
+  // virtual time since the start of the simulation
+  uint64_t nowUs() const { return now; }
+  // virtual time since boot or wake up, micros() on the target
+  uint32_t bootUs() const { return (uint32_t)(now - boot); }
+
+  void advance(uint64_t us);
+  void advanceTo(uint64_t us);
+
+  // ESP32 light sleep until the timer or a DIO line wakes up
+  void lightSleep(uint64_t timerUs);
+  // called by the host main loop after catching HostSimDeepSleep
+  void deepSleep(uint64_t sleepUs);
+  bool isWarmWake() const { return warmWake; }
+
+  void pinMode(uint8_t pin, uint8_t mode);
+  void digitalWrite(uint8_t pin, uint8_t value);
+  int digitalRead(uint8_t pin);
+  void attachInterrupt(uint8_t pin, void (*isr)());
+  void setInterruptsEnabled(bool enabled);
+
+  uint8_t spiTransfer(uint8_t data);
+
+  Sx127x radio;
+
+  // NVS, "namespace/key" -> value
+  std::map<std::string, std::vector<uint8_t>> nvs;
+  uint32_t nvsWrites;
+
+  uint16_t analogValue = 2400;
+
+private:
+  void dispatchInterrupts();
+
+  uint64_t now;
+  uint64_t boot;
+  bool warmWake;
+
+  uint8_t nssPin;
+  uint8_t rstPin;
+  uint8_t dioPins[3];
+  bool dioLevels[3];
+  void (*isrs[HOST_SIM_PINS])();
+  bool interruptsEnabled = true;
+  bool inInterrupt;
+  uint8_t levels[HOST_SIM_PINS];
+};
+
+extern HostSim hostSim;
+
+#endif
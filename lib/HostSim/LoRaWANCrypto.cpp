@@ -0,0 +1,177 @@
+#include <string.h>
+#include "LoRaWANCrypto.hpp"
+
+static const uint8_t sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16};
+
+static uint8_t xtime(uint8_t x)
+{
+  return (x << 1) ^ ((x & 0x80) ? 0x1b : 0x00);
+}
+
+void aes128Encrypt(const uint8_t key[16], const uint8_t input[16], uint8_t output[16])
+{
+  uint8_t roundKey[16];
+  uint8_t state[16];
+  uint8_t rcon = 0x01;
+
+  memcpy(roundKey, key, 16);
+  for (int i = 0; i < 16; i++)
+  {
+    state[i] = input[i] ^ roundKey[i];
+  }
+
+  for (int round = 1; round <= 10; round++)
+  {
+    // next round key
+    uint8_t t[4] = {sbox[roundKey[13]], sbox[roundKey[14]], sbox[roundKey[15]], sbox[roundKey[12]]};
+    t[0] ^= rcon;
+    rcon = xtime(rcon);
+    for (int i = 0; i < 16; i++)
+    {
+      roundKey[i] ^= i < 4 ? t[i] : roundKey[i - 4];
+    }
+
+    // SubBytes and ShiftRows, state is column major
+    uint8_t shifted[16];
+    for (int column = 0; column < 4; column++)
+    {
+      for (int row = 0; row < 4; row++)
+      {
+        shifted[column * 4 + row] = sbox[state[((column + row) % 4) * 4 + row]];
+      }
+    }
+
+    // MixColumns, not in the last round
+    for (int column = 0; column < 4; column++)
+    {
+      uint8_t *c = shifted + column * 4;
+      if (round < 10)
+      {
+        uint8_t all = c[0] ^ c[1] ^ c[2] ^ c[3];
+        uint8_t first = c[0];
+        c[0] ^= all ^ xtime(c[0] ^ c[1]);
+        c[1] ^= all ^ xtime(c[1] ^ c[2]);
+        c[2] ^= all ^ xtime(c[2] ^ c[3]);
+        c[3] ^= all ^ xtime(c[3] ^ first);
+      }
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+      state[i] = shifted[i] ^ roundKey[i];
+    }
+  }
+
+  memcpy(output, state, 16);
+}
+
+static void shiftLeft(const uint8_t input[16], uint8_t output[16])
+{
+  uint8_t carry = 0;
+  for (int i = 15; i >= 0; i--)
+  {
+    uint8_t next = input[i] >> 7;
+    output[i] = (input[i] << 1) | carry;
+    carry = next;
+  }
+  if (input[0] & 0x80)
+  {
+    output[15] ^= 0x87;
+  }
+}
+
+void aesCmac(const uint8_t key[16], const uint8_t *data, size_t length, uint8_t mac[16])
+{
+  uint8_t zero[16] = {0};
+  uint8_t l[16], k1[16], k2[16];
+  aes128Encrypt(key, zero, l);
+  shiftLeft(l, k1);
+  shiftLeft(k1, k2);
+
+  size_t blocks = length == 0 ? 1 : (length + 15) / 16;
+  bool complete = length > 0 && length % 16 == 0;
+  uint8_t x[16] = {0};
+
+  for (size_t block = 0; block < blocks; block++)
+  {
+    uint8_t y[16];
+    for (int i = 0; i < 16; i++)
+    {
+      size_t index = block * 16 + i;
+      uint8_t value = index < length ? data[index] : (index == length ? 0x80 : 0x00);
+      if (block == blocks - 1)
+      {
+        value ^= complete ? k1[i] : k2[i];
+      }
+      y[i] = x[i] ^ value;
+    }
+    aes128Encrypt(key, y, x);
+  }
+
+  memcpy(mac, x, 16);
+}
+
+static void blockHeader(uint8_t block[16], uint8_t type, uint32_t devAddr, uint32_t fcnt, uint8_t direction)
+{
+  memset(block, 0, 16);
+  block[0] = type;
+  block[5] = direction;
+  for (int i = 0; i < 4; i++)
+  {
+    block[6 + i] = devAddr >> (8 * i);
+    block[10 + i] = fcnt >> (8 * i);
+  }
+}
+
+uint32_t lorawanMic(const uint8_t nwkSKey[16], uint32_t devAddr, uint32_t fcnt, uint8_t direction,
+                    const uint8_t *frame, size_t length)
+{
+  uint8_t message[16 + 256];
+  uint8_t mac[16];
+
+  if (length > 256)
+  {
+    return 0;
+  }
+
+  blockHeader(message, 0x49, devAddr, fcnt, direction);
+  message[15] = length;
+  memcpy(message + 16, frame, length);
+  aesCmac(nwkSKey, message, 16 + length, mac);
+
+  return mac[0] | (mac[1] << 8) | (mac[2] << 16) | ((uint32_t)mac[3] << 24);
+}
+
+void lorawanCrypt(const uint8_t key[16], uint32_t devAddr, uint32_t fcnt, uint8_t direction,
+                  uint8_t *payload, size_t length)
+{
+  uint8_t a[16];
+  uint8_t s[16];
+
+  for (size_t offset = 0; offset < length; offset += 16)
+  {
+    blockHeader(a, 0x01, devAddr, fcnt, direction);
+    a[15] = offset / 16 + 1;
+    aes128Encrypt(key, a, s);
+    for (size_t i = 0; i < 16 && offset + i < length; i++)
+    {
+      payload[offset + i] ^= s[i];
+    }
+  }
+}
@@ -0,0 +1,21 @@
+#ifndef __LORAWAN_CRYPTO_H__
+#define __LORAWAN_CRYPTO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+// AES-128 encryption of one block, the only direction LoRaWAN 1.0 needs
+void aes128Encrypt(const uint8_t key[16], const uint8_t input[16], uint8_t output[16]);
+
+// AES-CMAC, RFC 4493
+void aesCmac(const uint8_t key[16], const uint8_t *data, size_t length, uint8_t mac[16]);
+
+// MIC of a data frame without the MIC itself, uplink direction 0
+uint32_t lorawanMic(const uint8_t nwkSKey[16], uint32_t devAddr, uint32_t fcnt, uint8_t direction,
+                    const uint8_t *frame, size_t length);
+
+// FRMPayload encryption, the same call decrypts
+void lorawanCrypt(const uint8_t key[16], uint32_t devAddr, uint32_t fcnt, uint8_t direction,
+                  uint8_t *payload, size_t length);
+
+#endif
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include "PacketForwarder.hpp"
+
+#define PROTOCOL_VERSION 2
+#define PUSH_DATA 0x00
+#define PUSH_ACK 0x01
+
+static const char base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static std::string base64Encode(const std::vector<uint8_t> &data)
+{
+    std::string encoded;
+    for (size_t i = 0; i < data.size(); i += 3)
+    {
+        uint32_t block = data[i] << 16;
+        if (i + 1 < data.size())
+        {
+            block |= data[i + 1] << 8;
+        }
+        if (i + 2 < data.size())
+        {
+            block |= data[i + 2];
+        }
+        encoded += base64Alphabet[(block >> 18) & 0x3f];
+        encoded += base64Alphabet[(block >> 12) & 0x3f];
+        encoded += i + 1 < data.size() ? base64Alphabet[(block >> 6) & 0x3f] : '=';
+        encoded += i + 2 < data.size() ? base64Alphabet[block & 0x3f] : '=';
+    }
+    return encoded;
+}
+
+PacketForwarder::PacketForwarder()
+    : socketFd(-1), token(0), gatewayEui{0xAA, 0x55, 0x5A, 0x00, 0x00, 0x00, 0x00, 0x01}, statistics()
+{
+}
+
+PacketForwarder::~PacketForwarder()
+{
+    if (socketFd >= 0)
+    {
+        close(socketFd);
+    }
+}
+
+bool PacketForwarder::begin(const char *server)
+{
+    std::string host = server;
+    std::string port = std::to_string(PACKET_FORWARDER_DEFAULT_PORT);
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos)
+    {
+        port = host.substr(colon + 1);
+        host = host.substr(0, colon);
+    }
+
+    struct addrinfo hints = {};
+    struct addrinfo *address;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &address) != 0)
+    {
+        fprintf(stderr, "packet forwarder: cannot resolve %s\n", server);
+        return false;
+    }
+
+    socketFd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (socketFd >= 0 && connect(socketFd, address->ai_addr, address->ai_addrlen) != 0)
+    {
+        close(socketFd);
+        socketFd = -1;
+    }
+    freeaddrinfo(address);
+
+    if (socketFd < 0)
+    {
+        perror("packet forwarder");
+        return false;
+    }
+    return true;
+}
+
+void PacketForwarder::push(const std::vector<uint8_t> &frame, uint32_t frequency, uint8_t spreadingFactor,
+                           uint32_t tmst, int16_t rssi, float snr)
+{
+    if (socketFd < 0)
+    {
+        return;
+    }
+
+    char json[640];
+    int length = snprintf(json, sizeof(json),
+                          "{\"rxpk\":[{\"tmst\":%u,\"chan\":0,\"rfch\":0,\"freq\":%.6f,\"stat\":1,"
+                          "\"modu\":\"LORA\",\"datr\":\"SF%uBW125\",\"codr\":\"4/5\",\"rssi\":%d,"
+                          "\"lsnr\":%.1f,\"size\":%u,\"data\":\"%s\"}]}",
+                          tmst, frequency / 1e6, spreadingFactor, rssi, snr, (unsigned)frame.size(),
+                          base64Encode(frame).c_str());
+    if (length < 0 || length >= (int)sizeof(json))
+    {
+        return;
+    }
+
+    std::vector<uint8_t> datagram = {PROTOCOL_VERSION, (uint8_t)(token >> 8), (uint8_t)token, PUSH_DATA};
+    datagram.insert(datagram.end(), gatewayEui, gatewayEui + sizeof(gatewayEui));
+    datagram.insert(datagram.end(), json, json + length);
+    token++;
+
+    if (send(socketFd, datagram.data(), datagram.size(), 0) == (ssize_t)datagram.size())
+    {
+        statistics.pushed++;
+    }
+}
+
+void PacketForwarder::poll()
+{
+    uint8_t reply[64];
+    ssize_t length;
+
+    while (socketFd >= 0 && (length = recv(socketFd, reply, sizeof(reply), MSG_DONTWAIT)) > 0)
+    {
+        if (length >= 4 && reply[0] == PROTOCOL_VERSION && reply[3] == PUSH_ACK)
+        {
+            statistics.acked++;
+        }
+    }
+}
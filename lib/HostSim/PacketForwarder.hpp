@@ -0,0 +1,45 @@
+#ifndef __PACKET_FORWARDER_H__
+#define __PACKET_FORWARDER_H__
+
+#include <stdint.h>
+#include <vector>
+
+#define PACKET_FORWARDER_DEFAULT_PORT 1700
+
+struct PacketForwarderStatistics
+{
+  uint32_t pushed;
+  uint32_t acked;
+};
+
+/*
+ * Gateway side of the Semtech UDP packet forwarder protocol (version 2).
+ * Every uplink of the simulated radio goes out as PUSH_DATA with one
+ * rxpk, the network server answers with PUSH_ACK. Downlinks (PULL_DATA)
+ * are not implemented.
+ */
+class PacketForwarder
+{
+public:
+  PacketForwarder();
+  ~PacketForwarder();
+
+  // "host" or "host:port"
+  bool begin(const char *server);
+  bool isActive() const { return socketFd >= 0; }
+
+  void push(const std::vector<uint8_t> &frame, uint32_t frequency, uint8_t spreadingFactor,
+            uint32_t tmst, int16_t rssi = -60, float snr = 8.0f);
+  // collect PUSH_ACKs without blocking
+  void poll();
+
+  const PacketForwarderStatistics &getStatistics() const { return statistics; }
+
+private:
+  int socketFd;
+  uint16_t token;
+  uint8_t gatewayEui[8];
+  PacketForwarderStatistics statistics;
+};
+
+#endif
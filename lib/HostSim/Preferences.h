@@ -0,0 +1,30 @@
+#ifndef __HOST_SIM_PREFERENCES_H__
+#define __HOST_SIM_PREFERENCES_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// ESP32 NVS stand-in, the values live in HostSim::nvs
+class Preferences
+{
+public:
+  bool begin(const char *name, bool readOnly = false);
+  void end() {}
+  bool clear();
+  bool remove(const char *key);
+
+  size_t putUInt(const char *key, uint32_t value);
+  uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+  size_t putBytes(const char *key, const void *value, size_t length);
+  size_t getBytes(const char *key, void *buffer, size_t maxLength);
+  size_t getBytesLength(const char *key);
+
+private:
+  std::string path(const char *key) const { return name + "/" + key; }
+
+  std::string name;
+  bool readOnly = false;
+};
+
+#endif
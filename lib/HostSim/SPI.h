@@ -0,0 +1,29 @@
+#ifndef __HOST_SIM_SPI_H__
+#define __HOST_SIM_SPI_H__
+
+#include <stdint.h>
+
+#define SPI_MODE0 0x00
+
+class SPISettings
+{
+public:
+  SPISettings() {}
+  SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {}
+};
+
+// every byte goes to the simulated SX127x, NSS is a GPIO
+class SPIClass
+{
+public:
+  void begin() {}
+  void begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss) {}
+  void end() {}
+  void beginTransaction(SPISettings settings) {}
+  void endTransaction() {}
+  uint8_t transfer(uint8_t data);
+};
+
+extern SPIClass SPI;
+
+#endif
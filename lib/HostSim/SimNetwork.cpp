@@ -0,0 +1,116 @@
+#include <string.h>
+#include <UplinkScheduler.hpp>
+#include "SimNetwork.hpp"
+#include "LoRaWANCrypto.hpp"
+
+#define MTYPE_CONFIRMED_UP 4
+#define MTYPE_UNCONFIRMED_DOWN 3
+#define FCTRL_ACK 0x20
+#define FRAME_HEADER_SIZE 8 // MHDR, DevAddr, FCtrl, FCnt
+#define FRAME_MIC_SIZE 4
+
+void SimNetwork::begin(const uint8_t nwkSKey[16], const uint8_t appSKey[16], uint32_t devAddr,
+                       uint8_t deliveryPercent)
+{
+    memcpy(this->nwkSKey, nwkSKey, 16);
+    memcpy(this->appSKey, appSKey, 16);
+    this->devAddr = devAddr;
+    this->deliveryPercent = deliveryPercent > 100 ? 100 : deliveryPercent;
+    random = 0x2545F491;
+}
+
+bool SimNetwork::delivered()
+{
+    random = random * 1103515245 + 12345;
+    return (random >> 16) % 100 < deliveryPercent;
+}
+
+void SimNetwork::uplink(const std::vector<uint8_t> &frame, Sx127x &radio)
+{
+    statistics.uplinks++;
+    if (frame.size() < FRAME_HEADER_SIZE + FRAME_MIC_SIZE || !delivered())
+    {
+        return;
+    }
+
+    uint32_t address = frame[1] | (frame[2] << 8) | (frame[3] << 16) | ((uint32_t)frame[4] << 24);
+    size_t portOffset = FRAME_HEADER_SIZE + (frame[5] & 0x0f);
+    size_t micOffset = frame.size() - FRAME_MIC_SIZE;
+    if (address != devAddr || portOffset > micOffset)
+    {
+        return;
+    }
+    statistics.received++;
+
+    // 32 bit frame counter from the 16 bits on air, LMIC repeats keep theirs
+    uint16_t fcnt16 = frame[6] | (frame[7] << 8);
+    uint32_t fcnt = (fcntUp & 0xffff0000) | fcnt16;
+    if (seen && fcnt + 0x8000 < fcntUp)
+    {
+        fcnt += 0x10000;
+    }
+    seen = true;
+    fcntUp = fcnt;
+
+    if (portOffset < micOffset && frame[portOffset] != 0)
+    {
+        uint8_t port = frame[portOffset];
+        std::vector<uint8_t> payload(frame.begin() + portOffset + 1, frame.begin() + micOffset);
+        lorawanCrypt(appSKey, address, fcnt, 0, payload.data(), payload.size());
+        receivePayload(port, payload);
+    }
+
+    if ((frame[0] >> 5) == MTYPE_CONFIRMED_UP)
+    {
+        statistics.confirmed++;
+        if (delivered())
+        {
+            queueAck(radio);
+        }
+    }
+}
+
+void SimNetwork::receivePayload(uint8_t port, const std::vector<uint8_t> &payload)
+{
+    if (port != UPLINK_COALESCED_PORT)
+    {
+        statistics.payloads += payloads.insert(payload).second;
+        return;
+    }
+
+    for (size_t pos = 0; pos + UPLINK_COALESCED_HEADER <= payload.size();)
+    {
+        size_t end = pos + UPLINK_COALESCED_HEADER + payload[pos + 1];
+        if (end > payload.size())
+        {
+            return;
+        }
+        receivePayload(payload[pos], std::vector<uint8_t>(payload.begin() + pos + UPLINK_COALESCED_HEADER,
+                                                          payload.begin() + end));
+        pos = end;
+    }
+}
+
+// empty unconfirmed downlink with the ACK bit, LMIC checks the MIC and the counter
+void SimNetwork::queueAck(Sx127x &radio)
+{
+    uint8_t frame[FRAME_HEADER_SIZE + FRAME_MIC_SIZE];
+    frame[0] = MTYPE_UNCONFIRMED_DOWN << 5;
+    frame[1] = devAddr;
+    frame[2] = devAddr >> 8;
+    frame[3] = devAddr >> 16;
+    frame[4] = devAddr >> 24;
+    frame[5] = FCTRL_ACK;
+    frame[6] = fcntDown;
+    frame[7] = fcntDown >> 8;
+
+    uint32_t mic = lorawanMic(nwkSKey, devAddr, fcntDown, 1, frame, FRAME_HEADER_SIZE);
+    for (int i = 0; i < FRAME_MIC_SIZE; i++)
+    {
+        frame[FRAME_HEADER_SIZE + i] = mic >> (8 * i);
+    }
+
+    radio.queueDownlink(frame, sizeof(frame));
+    fcntDown++;
+    statistics.acks++;
+}
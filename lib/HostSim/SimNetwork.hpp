@@ -0,0 +1,57 @@
+#ifndef __SIM_NETWORK_H__
+#define __SIM_NETWORK_H__
+
+#include <stdint.h>
+#include <set>
+#include <vector>
+#include "Sx127x.hpp"
+
+struct SimNetworkStatistics
+{
+  uint32_t uplinks;
+  uint32_t received;  // made it through the simulated link
+  uint32_t confirmed; // received and asking for an ack
+  uint32_t acks;      // ack downlinks that made it back
+  uint32_t payloads;  // distinct application payloads received
+};
+
+/*
+ * Network server side of the host simulation for an ABP device. Each
+ * uplink and each ack downlink gets through with the given probability.
+ * Received confirmed uplinks are acked in RX1 with a frame LMIC accepts.
+ * Application payloads are decrypted and counted once, whatever FPort,
+ * frame counter or coalesced uplink carried them, so retransmissions
+ * and the backlog do not count twice.
+ */
+class SimNetwork
+{
+public:
+  void begin(const uint8_t nwkSKey[16], const uint8_t appSKey[16], uint32_t devAddr,
+             uint8_t deliveryPercent);
+
+  // a frame left the radio, an ack is queued on it if one is due
+  void uplink(const std::vector<uint8_t> &frame, Sx127x &radio);
+
+  uint8_t getDeliveryPercent() const { return deliveryPercent; }
+  const SimNetworkStatistics &getStatistics() const { return statistics; }
+
+private:
+  bool delivered();
+  void receivePayload(uint8_t port, const std::vector<uint8_t> &payload);
+  void queueAck(Sx127x &radio);
+
+  uint8_t nwkSKey[16];
+  uint8_t appSKey[16];
+  uint32_t devAddr = 0;
+  uint8_t deliveryPercent = 100;
+  uint32_t random = 0;
+
+  bool seen = false;
+  uint32_t fcntUp = 0;
+  uint16_t fcntDown = 0;
+
+  std::set<std::vector<uint8_t>> payloads;
+  SimNetworkStatistics statistics = {};
+};
+
+#endif
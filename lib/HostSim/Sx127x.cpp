@@ -0,0 +1,303 @@
+#include <string.h>
+#include <Airtime.hpp>
+#include "Sx127x.hpp"
+
+#define REG_FIFO 0x00
+#define REG_OP_MODE 0x01
+#define REG_FRF_MSB 0x06
+#define REG_FIFO_ADDR_PTR 0x0D
+#define REG_FIFO_TX_BASE_ADDR 0x0E
+#define REG_FIFO_RX_BASE_ADDR 0x0F
+#define REG_FIFO_RX_CURRENT_ADDR 0x10
+#define REG_IRQ_FLAGS_MASK 0x11
+#define REG_IRQ_FLAGS 0x12
+#define REG_RX_NB_BYTES 0x13
+#define REG_PKT_SNR_VALUE 0x19
+#define REG_PKT_RSSI_VALUE 0x1A
+#define REG_MODEM_CONFIG1 0x1D
+#define REG_MODEM_CONFIG2 0x1E
+#define REG_SYMB_TIMEOUT_LSB 0x1F
+#define REG_PREAMBLE_MSB 0x20
+#define REG_PREAMBLE_LSB 0x21
+#define REG_PAYLOAD_LENGTH 0x22
+#define REG_RSSI_WIDEBAND 0x2C
+#define REG_IMAGE_CAL 0x3B
+#define REG_VERSION 0x42
+
+#define MODE_LORA 0x80
+#define MODE_MASK 0x07
+#define MODE_STANDBY 0x01
+#define MODE_TX 0x03
+#define MODE_RX_SINGLE 0x06
+
+#define IRQ_RX_TIMEOUT 0x80
+#define IRQ_RX_DONE 0x40
+#define IRQ_VALID_HEADER 0x10
+#define IRQ_TX_DONE 0x08
+
+#define IMAGE_CAL_RUNNING 0x20
+
+// SX1276, LMIC checks it in radio_init()
+#define VERSION_SX1276 0x12
+
+// HF port: RSSI = PktRssiValue - 157
+#define RSSI_OFFSET 157
+
+void Sx127x::reset()
+{
+    memset(registers, 0, sizeof(registers));
+    memset(fifo, 0, sizeof(fifo));
+    registers[REG_OP_MODE] = 0x09;
+    registers[REG_FRF_MSB] = 0x6c;
+    registers[REG_FRF_MSB + 1] = 0x80;
+    registers[REG_FIFO_TX_BASE_ADDR] = 0x80;
+    registers[REG_MODEM_CONFIG1] = 0x72;
+    registers[REG_MODEM_CONFIG2] = 0x70;
+    registers[REG_SYMB_TIMEOUT_LSB] = 0x64;
+    registers[REG_PREAMBLE_LSB] = 0x08;
+    registers[REG_PAYLOAD_LENGTH] = 0x01;
+    registers[REG_IMAGE_CAL] = 0x82;
+    registers[REG_VERSION] = VERSION_SX1276;
+
+    selected = false;
+    firstByte = false;
+    writing = false;
+    address = 0;
+    pendingFlags = 0;
+    eventUs = SX127X_NO_EVENT;
+    if (random == 0)
+    {
+        random = 0x12345678;
+    }
+}
+
+void Sx127x::select(bool selected)
+{
+    this->selected = selected;
+    firstByte = selected;
+}
+
+uint8_t Sx127x::transfer(uint8_t data, uint64_t nowUs)
+{
+    if (!selected)
+    {
+        return 0;
+    }
+
+    if (firstByte)
+    {
+        // address byte, bit 7 set for a write
+        firstByte = false;
+        writing = (data & 0x80) != 0;
+        address = data & 0x7f;
+        return 0;
+    }
+
+    uint8_t result = 0;
+    if (writing)
+    {
+        writeRegister(address, data, nowUs);
+    }
+    else
+    {
+        result = readRegister(address);
+    }
+
+    // burst access stays on the FIFO, otherwise moves to the next register
+    if (address != REG_FIFO)
+    {
+        address = (address + 1) & 0x7f;
+    }
+    return result;
+}
+
+void Sx127x::writeRegister(uint8_t address, uint8_t value, uint64_t nowUs)
+{
+    bool lora = (registers[REG_OP_MODE] & MODE_LORA) != 0;
+
+    switch (address)
+    {
+    case REG_FIFO:
+        fifo[registers[REG_FIFO_ADDR_PTR]++] = value;
+        break;
+
+    case REG_OP_MODE:
+        registers[REG_OP_MODE] = value;
+        setMode(value & MODE_MASK, nowUs);
+        break;
+
+    case REG_IRQ_FLAGS:
+        if (lora)
+        {
+            // write 1 to clear
+            registers[REG_IRQ_FLAGS] &= ~value;
+        }
+        else
+        {
+            registers[address] = value;
+        }
+        break;
+
+    case REG_IMAGE_CAL:
+        // calibration finishes at once
+        registers[address] = value & ~IMAGE_CAL_RUNNING;
+        break;
+
+    case REG_VERSION:
+        break;
+
+    default:
+        registers[address] = value;
+        break;
+    }
+}
+
+uint8_t Sx127x::readRegister(uint8_t address)
+{
+    switch (address)
+    {
+    case REG_FIFO:
+        return fifo[registers[REG_FIFO_ADDR_PTR]++];
+
+    case REG_RSSI_WIDEBAND:
+        // noise, LMIC seeds its random generator from the low bit
+        random = random * 1103515245 + 12345;
+        return random >> 16;
+
+    default:
+        return registers[address];
+    }
+}
+
+void Sx127x::setMode(uint8_t mode, uint64_t nowUs)
+{
+    // a mode change aborts a running TX or RX
+    pendingFlags = 0;
+    eventUs = SX127X_NO_EVENT;
+
+    if (!(registers[REG_OP_MODE] & MODE_LORA))
+    {
+        return;
+    }
+
+    if (mode == MODE_TX)
+    {
+        uint8_t length = registers[REG_PAYLOAD_LENGTH];
+        uint8_t start = registers[REG_FIFO_TX_BASE_ADDR];
+        uint32_t airtime = timeOnAirUs(length);
+
+        lastUplink.clear();
+        for (uint8_t i = 0; i < length; i++)
+        {
+            lastUplink.push_back(fifo[(uint8_t)(start + i)]);
+        }
+        lastFrequency = frequency();
+        lastSpreadingFactor = spreadingFactor();
+
+        statistics.txCount++;
+        statistics.txAirtimeUs += airtime;
+        pendingFlags = IRQ_TX_DONE;
+        eventUs = nowUs + airtime;
+    }
+    else if (mode == MODE_RX_SINGLE)
+    {
+        statistics.rxWindows++;
+
+        if (!downlink.empty())
+        {
+            uint8_t start = registers[REG_FIFO_RX_BASE_ADDR];
+            for (size_t i = 0; i < downlink.size(); i++)
+            {
+                fifo[(uint8_t)(start + i)] = downlink[i];
+            }
+            registers[REG_FIFO_RX_CURRENT_ADDR] = start;
+            registers[REG_RX_NB_BYTES] = downlink.size();
+            registers[REG_PKT_SNR_VALUE] = (uint8_t)(downlinkSnr * 4);
+            registers[REG_PKT_RSSI_VALUE] = downlinkRssi + RSSI_OFFSET;
+
+            pendingFlags = IRQ_RX_DONE | IRQ_VALID_HEADER;
+            eventUs = nowUs + timeOnAirUs(downlink.size());
+            downlink.clear();
+        }
+        else
+        {
+            uint32_t symbols = ((registers[REG_MODEM_CONFIG2] & 0x03) << 8) | registers[REG_SYMB_TIMEOUT_LSB];
+            uint32_t symbolUs = (uint32_t)((1000000ULL << spreadingFactor()) / bandwidthHz());
+
+            pendingFlags = IRQ_RX_TIMEOUT;
+            eventUs = nowUs + symbols * symbolUs;
+        }
+    }
+}
+
+void Sx127x::update(uint64_t nowUs)
+{
+    if (eventUs == SX127X_NO_EVENT || nowUs < eventUs)
+    {
+        return;
+    }
+
+    if (pendingFlags & IRQ_RX_DONE)
+    {
+        statistics.rxDone++;
+    }
+    if (pendingFlags & IRQ_RX_TIMEOUT)
+    {
+        statistics.rxTimeouts++;
+    }
+
+    registers[REG_IRQ_FLAGS] |= pendingFlags;
+    // TX and single RX return to standby
+    registers[REG_OP_MODE] = (registers[REG_OP_MODE] & ~MODE_MASK) | MODE_STANDBY;
+    pendingFlags = 0;
+    eventUs = SX127X_NO_EVENT;
+}
+
+bool Sx127x::dio(uint8_t n) const
+{
+    uint8_t flags = registers[REG_IRQ_FLAGS] & ~registers[REG_IRQ_FLAGS_MASK];
+
+    switch (n)
+    {
+    case 0:
+        return (flags & (IRQ_TX_DONE | IRQ_RX_DONE)) != 0;
+    case 1:
+        return (flags & IRQ_RX_TIMEOUT) != 0;
+    default:
+        return false;
+    }
+}
+
+void Sx127x::queueDownlink(const uint8_t *frame, uint8_t length, int16_t rssi, int8_t snr)
+{
+    downlink.assign(frame, frame + length);
+    downlinkRssi = rssi;
+    downlinkSnr = snr;
+}
+
+uint32_t Sx127x::bandwidthHz() const
+{
+    switch (registers[REG_MODEM_CONFIG1] >> 4)
+    {
+    case 8:
+        return 250000;
+    case 9:
+        return 500000;
+    default:
+        return 125000;
+    }
+}
+
+uint32_t Sx127x::frequency() const
+{
+    uint32_t frf = (registers[REG_FRF_MSB] << 16) | (registers[REG_FRF_MSB + 1] << 8) | registers[REG_FRF_MSB + 2];
+    return ((uint64_t)frf * 32000000) >> 19;
+}
+
+uint32_t Sx127x::timeOnAirUs(uint8_t length) const
+{
+    uint8_t config1 = registers[REG_MODEM_CONFIG1];
+    return airtimeUs(spreadingFactor(), bandwidthHz(), (config1 >> 1) & 0x07, length,
+                     (registers[REG_MODEM_CONFIG2] & 0x04) != 0, (config1 & 0x01) != 0,
+                     (registers[REG_PREAMBLE_MSB] << 8) | registers[REG_PREAMBLE_LSB]);
+}
@@ -0,0 +1,78 @@
+#ifndef __SX127X_H__
+#define __SX127X_H__
+
+#include <stdint.h>
+#include <vector>
+
+#define SX127X_NO_EVENT UINT64_MAX
+
+struct Sx127xStatistics
+{
+  uint32_t txCount;
+  uint64_t txAirtimeUs;
+  uint32_t rxWindows;
+  uint32_t rxDone;
+  uint32_t rxTimeouts;
+};
+
+/*
+ * Register level model of a SX1276 in LoRa mode, as far as LMIC uses it.
+ * TX completes after the time on air of the frame, a single RX window
+ * times out after the configured symbols unless a downlink is queued.
+ * DIO0 signals TxDone/RxDone and DIO1 RxTimeout.
+ */
+class Sx127x
+{
+public:
+  void reset();
+
+  // SPI transaction framing by NSS, then one byte at a time
+  void select(bool selected);
+  uint8_t transfer(uint8_t data, uint64_t nowUs);
+
+  // raise the interrupts that are due
+  void update(uint64_t nowUs);
+  uint64_t nextEventUs() const { return eventUs; }
+  bool dio(uint8_t n) const;
+
+  // received in the next single RX window
+  void queueDownlink(const uint8_t *frame, uint8_t length, int16_t rssi = -60, int8_t snr = 8);
+
+  const std::vector<uint8_t> &getLastUplink() const { return lastUplink; }
+  uint32_t getLastFrequency() const { return lastFrequency; }
+  uint8_t getLastSpreadingFactor() const { return lastSpreadingFactor; }
+  const Sx127xStatistics &getStatistics() const { return statistics; }
+
+private:
+  void writeRegister(uint8_t address, uint8_t value, uint64_t nowUs);
+  uint8_t readRegister(uint8_t address);
+  void setMode(uint8_t mode, uint64_t nowUs);
+
+  uint8_t spreadingFactor() const { return registers[0x1E] >> 4; }
+  uint32_t bandwidthHz() const;
+  uint32_t frequency() const;
+  uint32_t timeOnAirUs(uint8_t length) const;
+
+  uint8_t registers[0x80];
+  uint8_t fifo[256];
+
+  bool selected;
+  bool firstByte;
+  bool writing;
+  uint8_t address;
+
+  uint8_t pendingFlags; // raised at eventUs
+  uint64_t eventUs;
+  uint32_t random;
+
+  std::vector<uint8_t> downlink;
+  int16_t downlinkRssi;
+  int8_t downlinkSnr;
+
+  std::vector<uint8_t> lastUplink;
+  uint32_t lastFrequency;
+  uint8_t lastSpreadingFactor;
+  Sx127xStatistics statistics;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef __HOST_SIM_DRIVER_GPIO_H__
+#define __HOST_SIM_DRIVER_GPIO_H__
+
+typedef int gpio_num_t;
+
+typedef enum
+{
+  GPIO_INTR_DISABLE,
+  GPIO_INTR_POSEDGE,
+  GPIO_INTR_NEGEDGE,
+  GPIO_INTR_ANYEDGE,
+  GPIO_INTR_LOW_LEVEL,
+  GPIO_INTR_HIGH_LEVEL
+} gpio_int_type_t;
+
+// the simulated light sleep always wakes up on the DIO lines
+inline int gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) { return 0; }
+
+#endif
@@ -0,0 +1,127 @@
+#include "LinkAdr.hpp"
+
+// SX127x demodulation floor in 0.25 dB, SF7 .. SF12
+static const int16_t SNR_FLOOR[] = {-30, -40, -50, -60, -70, -80};
+
+void LinkAdr::begin(uint8_t minDataRate, uint8_t maxDataRate, int8_t minPower, int8_t maxPower)
+{
+    this->minDataRate = minDataRate;
+    this->maxDataRate = maxDataRate;
+    this->minPower = minPower;
+    this->maxPower = maxPower;
+}
+
+int16_t LinkAdr::requiredSnr(uint8_t spreadingFactor)
+{
+    if (spreadingFactor < 7)
+    {
+        spreadingFactor = 7;
+    }
+    if (spreadingFactor > 12)
+    {
+        spreadingFactor = 12;
+    }
+    return SNR_FLOOR[spreadingFactor - 7] + LINK_ADR_MARGIN_DB * 4;
+}
+
+void LinkAdr::update(uint8_t dataRate, bool rx1Received, int8_t snr,
+                     bool ackRequested, bool acked)
+{
+    if (ackRequested)
+    {
+        missedAcks = acked ? 0 : missedAcks + 1;
+    }
+
+    if (rx1Received)
+    {
+        // EU868 style data rates, maxDataRate is SF7
+        uint8_t spreadingFactor = 7 + (maxDataRate - dataRate);
+        lastMargin = snr - requiredSnr(spreadingFactor);
+
+        if (count < LINK_ADR_HISTORY)
+        {
+            margins[count++] = lastMargin;
+        }
+        else
+        {
+            for (int i = 1; i < LINK_ADR_HISTORY; i++)
+            {
+                margins[i - 1] = margins[i];
+            }
+            margins[LINK_ADR_HISTORY - 1] = lastMargin;
+        }
+    }
+}
+
+bool LinkAdr::adjust(uint8_t &dataRate, int8_t &power)
+{
+    if (missedAcks >= LINK_ADR_ACK_LIMIT)
+    {
+        // fall back, power first because it costs no airtime
+        missedAcks = 0;
+        count = 0;
+        if (power < maxPower)
+        {
+            power = maxPower;
+            return true;
+        }
+        if (dataRate > minDataRate)
+        {
+            dataRate--;
+            return true;
+        }
+        return false;
+    }
+
+    if (count < LINK_ADR_HISTORY)
+    {
+        return false;
+    }
+
+    // the worst of the recent downlinks decides
+    int16_t margin = margins[0];
+    for (int i = 1; i < LINK_ADR_HISTORY; i++)
+    {
+        if (margins[i] < margin)
+        {
+            margin = margins[i];
+        }
+    }
+
+    bool changed = false;
+
+    // an unacknowledged uplink speaks against a faster setting
+    if (margin >= LINK_ADR_STEP_DB * 4 && missedAcks == 0)
+    {
+        if (dataRate < maxDataRate)
+        {
+            dataRate++;
+            changed = true;
+        }
+        else if (power - LINK_ADR_POWER_STEP >= minPower)
+        {
+            power -= LINK_ADR_POWER_STEP;
+            changed = true;
+        }
+    }
+    else if (margin < 0)
+    {
+        if (power < maxPower)
+        {
+            power = maxPower;
+            changed = true;
+        }
+        else if (dataRate > minDataRate)
+        {
+            dataRate--;
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        // hysteresis: collect a new history with the new setting
+        count = 0;
+    }
+    return changed;
+}
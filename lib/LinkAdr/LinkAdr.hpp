@@ -0,0 +1,64 @@
+#ifndef __LINK_ADR_H__
+#define __LINK_ADR_H__
+
+#include <stdint.h>
+
+// margin kept on top of the demodulation floor, dB
+#ifndef LINK_ADR_MARGIN_DB
+#define LINK_ADR_MARGIN_DB 10
+#endif
+
+// downlinks with enough margin before stepping to a faster setting
+#ifndef LINK_ADR_HISTORY
+#define LINK_ADR_HISTORY 4
+#endif
+
+// missed acks in a row before falling back to a more robust setting
+#ifndef LINK_ADR_ACK_LIMIT
+#define LINK_ADR_ACK_LIMIT 2
+#endif
+
+#define LINK_ADR_STEP_DB 3
+#define LINK_ADR_POWER_STEP 2
+
+/*
+ * Device side link margin tracking. The SNR of downlinks received in RX1
+ * is compared with the demodulation floor of the spreading factor in use;
+ * RX1 answers at the uplink's data rate (TTN's RX1 DR offset is 0), RX2
+ * at a fixed one, so only RX1 downlinks are counted.
+ * With enough margin the data rate is raised first, then the TX power
+ * is lowered, one step at a time, but not while an ack is missing.
+ * Missed acks step back.
+ *
+ * Data rates are 0 = slowest (SF12) to maxDataRate (SF7).
+ */
+class LinkAdr
+{
+public:
+  void begin(uint8_t minDataRate, uint8_t maxDataRate, int8_t minPower, int8_t maxPower);
+
+  // snr in 0.25 dB of a downlink in RX1, only valid if rx1Received
+  void update(uint8_t dataRate, bool rx1Received, int8_t snr,
+              bool ackRequested, bool acked);
+
+  // true if dataRate and/or power should be changed
+  bool adjust(uint8_t &dataRate, int8_t &power);
+
+  int8_t getMarginDb() const { return lastMargin / 4; }
+  uint8_t getMissedAcks() const { return missedAcks; }
+
+private:
+  static int16_t requiredSnr(uint8_t spreadingFactor);
+
+  uint8_t minDataRate;
+  uint8_t maxDataRate;
+  int8_t minPower;
+  int8_t maxPower;
+
+  int16_t margins[LINK_ADR_HISTORY]; // 0.25 dB
+  uint8_t count;
+  int16_t lastMargin;
+  uint8_t missedAcks;
+};
+
+#endif
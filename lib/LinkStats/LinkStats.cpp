@@ -0,0 +1,160 @@
+#include "LinkStats.hpp"
+
+static uint8_t binOf(int16_t value, int16_t floor, int16_t step, uint8_t count)
+{
+    if (value < floor)
+    {
+        return 0;
+    }
+    uint16_t bin = (value - floor) / step;
+    return bin < count ? bin : count - 1;
+}
+
+// to the nearest integer, halves away from zero
+static int32_t roundedDivide(int32_t sum, int32_t count)
+{
+    return (sum < 0 ? sum - count / 2 : sum + count / 2) / count;
+}
+
+void LinkStats::begin()
+{
+    if (valid)
+    {
+        return;
+    }
+    next = 0;
+    sequence = 0;
+    snapshot = LinkStatsSnapshot();
+    valid = true;
+}
+
+void LinkStats::add(const LinkSample &sample, int8_t sign)
+{
+    snapshot.uplinks += sign;
+    snapshot.airtimeUs += sign * (int32_t)sample.airtimeUs;
+    if (sample.spreadingFactor >= LINK_STATS_SF_MIN)
+    {
+        snapshot.spreadingFactors[binOf(sample.spreadingFactor, LINK_STATS_SF_MIN, 1, LINK_STATS_SF_BINS)] += sign;
+    }
+    if (sample.flags & LINK_ACK_REQUESTED)
+    {
+        snapshot.ackRequested += sign;
+        if (sample.flags & LINK_ACKED)
+        {
+            snapshot.acked += sign;
+        }
+    }
+
+    // RSSI and SNR are stale without a downlink
+    if (!(sample.flags & (LINK_RX1 | LINK_RX2)))
+    {
+        return;
+    }
+    if (sample.flags & LINK_RX1)
+    {
+        snapshot.rx1 += sign;
+    }
+    else
+    {
+        snapshot.rx2 += sign;
+    }
+    snapshot.rssiSum += sign * sample.rssi;
+    snapshot.snrSum += sign * sample.snr;
+    snapshot.rssiBins[binOf(sample.rssi, LINK_STATS_RSSI_FLOOR, LINK_STATS_RSSI_STEP, LINK_STATS_RSSI_BINS)] += sign;
+    snapshot.snrBins[binOf(sample.snr, LINK_STATS_SNR_FLOOR, LINK_STATS_SNR_STEP, LINK_STATS_SNR_BINS)] += sign;
+}
+
+void LinkStats::update(const LinkSample &sample)
+{
+    sequence++;
+    __sync_synchronize();
+
+    // the oldest sample leaves the window
+    if (snapshot.uplinks == LINK_STATS_WINDOW)
+    {
+        add(samples[next], -1);
+    }
+    samples[next] = sample;
+    add(sample, 1);
+    next = (next + 1) % LINK_STATS_WINDOW;
+
+    snapshot.last = sample;
+    snapshot.totalUplinks++;
+    if (sample.flags & (LINK_RX1 | LINK_RX2))
+    {
+        snapshot.totalDownlinks++;
+    }
+    snapshot.totalAirtimeUs += sample.airtimeUs;
+
+    __sync_synchronize();
+    sequence++;
+}
+
+uint32_t LinkStats::beginRead() const
+{
+    uint32_t current;
+    while ((current = sequence) & 1)
+    {
+    }
+    __sync_synchronize();
+    return current;
+}
+
+bool LinkStats::endRead(uint32_t sequence) const
+{
+    __sync_synchronize();
+    return this->sequence == sequence;
+}
+
+int16_t LinkStats::meanRssi(const LinkStatsSnapshot &snapshot)
+{
+    uint8_t received = snapshot.rx1 + snapshot.rx2;
+    return received ? roundedDivide(snapshot.rssiSum, received) : 0;
+}
+
+int8_t LinkStats::meanSnr(const LinkStatsSnapshot &snapshot)
+{
+    uint8_t received = snapshot.rx1 + snapshot.rx2;
+    return received ? roundedDivide(snapshot.snrSum, received) : 0;
+}
+
+uint32_t LinkStats::meanAirtimeUs(const LinkStatsSnapshot &snapshot)
+{
+    return snapshot.uplinks ? snapshot.airtimeUs / snapshot.uplinks : 0;
+}
+
+uint8_t LinkStats::ackRate(const LinkStatsSnapshot &snapshot)
+{
+    if (snapshot.ackRequested == 0)
+    {
+        return 100;
+    }
+    return (snapshot.acked * 100 + snapshot.ackRequested / 2) / snapshot.ackRequested;
+}
+
+uint8_t LinkStats::percentileBin(const uint8_t *bins, uint8_t count, uint8_t percent)
+{
+    uint16_t total = 0;
+    for (uint8_t bin = 0; bin < count; bin++)
+    {
+        total += bins[bin];
+    }
+
+    // the sample at the percentile, counted from 1
+    uint16_t rank = (total * percent + 99) / 100;
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    uint16_t seen = 0;
+    for (uint8_t bin = 0; bin < count; bin++)
+    {
+        seen += bins[bin];
+        if (seen >= rank)
+        {
+            return bin;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+#ifndef __LINK_STATS_H__
+#define __LINK_STATS_H__
+
+#include <stdint.h>
+
+// uplinks in the rolling window, counts per window fit a byte
+#ifndef LINK_STATS_WINDOW
+#define LINK_STATS_WINDOW 32
+#endif
+
+// RSSI histogram, 10 dB bins from -130 dBm, the outer bins are open ended
+#define LINK_STATS_RSSI_BINS 8
+#define LINK_STATS_RSSI_FLOOR -130
+#define LINK_STATS_RSSI_STEP 10
+
+// SNR histogram, 4 dB bins from -20 dB, the outer bins are open ended
+#define LINK_STATS_SNR_BINS 8
+#define LINK_STATS_SNR_FLOOR -20
+#define LINK_STATS_SNR_STEP 4
+
+// SF7 to SF12
+#define LINK_STATS_SF_BINS 6
+#define LINK_STATS_SF_MIN 7
+
+// LinkSample flags
+#define LINK_ACK_REQUESTED 0x01
+#define LINK_ACKED 0x02
+#define LINK_RX1 0x04 // a downlink arrived in RX1
+#define LINK_RX2 0x08
+
+static_assert(LINK_STATS_WINDOW > 0 && LINK_STATS_WINDOW <= 255, "LINK_STATS_WINDOW must be 1 to 255");
+
+// One uplink as seen at EV_TXCOMPLETE, RSSI and SNR are of its downlink
+struct LinkSample
+{
+  uint32_t airtimeUs; // all transmissions of the frame
+  int16_t rssi;
+  int8_t snr;
+  uint8_t spreadingFactor;
+  uint8_t flags; // LINK_*
+};
+
+struct LinkStatsSnapshot
+{
+  // the last LINK_STATS_WINDOW uplinks
+  uint8_t uplinks;
+  uint8_t rx1;
+  uint8_t rx2;
+  uint8_t ackRequested;
+  uint8_t acked;
+  int32_t rssiSum; // of the uplinks with a downlink
+  int32_t snrSum;
+  uint32_t airtimeUs;
+  uint8_t spreadingFactors[LINK_STATS_SF_BINS];
+  uint8_t rssiBins[LINK_STATS_RSSI_BINS];
+  uint8_t snrBins[LINK_STATS_SNR_BINS];
+
+  LinkSample last;
+
+  // since the last cold boot
+  uint32_t totalUplinks;
+  uint32_t totalDownlinks;
+  uint64_t totalAirtimeUs;
+};
+
+/*
+ * Rolling window and histograms of the link quality of the recent
+ * uplinks. Each sample is added to the running sums and bins and the
+ * one it replaces in the ring is subtracted, so an update takes the
+ * same few integer operations whatever the window size.
+ *
+ * Consumers read the snapshot in place. On the core that updates it
+ * (processEvents()) that needs nothing else; the render task brackets
+ * its reads with beginRead() and endRead() and retries if an update
+ * ran in between.
+ *
+ * Plain C++, the object can live in RTC memory.
+ */
+class LinkStats
+{
+public:
+  // keeps the window over deep sleep, empty after a cold boot
+  void begin();
+
+  void update(const LinkSample &sample);
+
+  const LinkStatsSnapshot &getSnapshot() const { return snapshot; }
+
+  // even sequence number to pass to endRead(), waits while an update runs
+  uint32_t beginRead() const;
+  // false if the snapshot changed since beginRead()
+  bool endRead(uint32_t sequence) const;
+
+  // rounded means of the uplinks with a downlink, 0 if there was none
+  static int16_t meanRssi(const LinkStatsSnapshot &snapshot);
+  static int8_t meanSnr(const LinkStatsSnapshot &snapshot);
+  static uint32_t meanAirtimeUs(const LinkStatsSnapshot &snapshot);
+  // percent of the confirmed uplinks in the window, 100 if there was none
+  static uint8_t ackRate(const LinkStatsSnapshot &snapshot);
+
+  // bin the given percentile of a histogram falls into, 0 if it is empty
+  static uint8_t percentileBin(const uint8_t *bins, uint8_t count, uint8_t percent);
+  // lowest value of a bin, the first bin also holds everything below
+  static int16_t rssiBinFloor(uint8_t bin) { return LINK_STATS_RSSI_FLOOR + bin * LINK_STATS_RSSI_STEP; }
+  static int16_t snrBinFloor(uint8_t bin) { return LINK_STATS_SNR_FLOOR + bin * LINK_STATS_SNR_STEP; }
+
+private:
+  void add(const LinkSample &sample, int8_t sign);
+
+  bool valid;
+  uint8_t next; // ring slot the next sample goes to
+  volatile uint32_t sequence; // odd while an update runs
+  LinkSample samples[LINK_STATS_WINDOW];
+  LinkStatsSnapshot snapshot;
+};
+
+#endif
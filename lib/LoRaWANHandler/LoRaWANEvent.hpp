@@ -0,0 +1,52 @@
+#ifndef __LORAWAN_EVENT_H__
+#define __LORAWAN_EVENT_H__
+
+#include <stdint.h>
+#include <lmic.h>
+
+// Copy of the LMIC state at the time an event was reported
+struct LoRaWANEvent
+{
+  ev_t ev;
+  ostime_t timestamp;
+  uint32_t enqueuedUs;
+  uint32_t freq; // of the uplink at EV_TXSTART, of the last RX window afterwards
+  uint32_t seqnoUp;
+  int16_t rssi;
+  int8_t snr;
+  rps_t rps; // as freq
+  uint8_t dataLen;
+  uint8_t txrxFlags;
+  ostime_t txend;  // TX done, as LMIC saw DIO0
+  ostime_t rxtime; // scheduled RX start, after a reception RX done
+  // micros() of the last rising DIO0 (TX or RX done) and DIO1 (RX timeout)
+  // edge, 0 = not recorded: with LMIC_USE_INTERRUPTS the HAL owns the lines
+  uint32_t dio0Us;
+  uint32_t dio1Us;
+};
+
+struct LoRaWANEventStatistics
+{
+  uint32_t enqueued;
+  uint32_t dropped;
+  uint32_t processed;
+  uint32_t lastLatencyUs;
+  uint32_t maxLatencyUs;
+  uint64_t sumLatencyUs;
+};
+
+// Cycles spent in the handler and hook of one event type
+struct LoRaWANHandlerProfile
+{
+  uint32_t calls;
+  uint32_t lastCycles;
+  uint32_t maxCycles;
+  uint64_t sumCycles;
+};
+
+typedef void (*LoRaWANEventHandler)(const LoRaWANEvent &event);
+
+// ev_t values are 1 to EV_JOIN_TXCOMPLETE
+#define LORAWAN_EVENT_COUNT (EV_JOIN_TXCOMPLETE + 1)
+
+#endif
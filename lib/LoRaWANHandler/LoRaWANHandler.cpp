@@ -34,19 +34,116 @@
 #include <Arduino.h>
 #include <lmic.h>
 #include <hal/hal.h>
+#ifdef DISPLAY_ENABLED
 #include <DisplayHandler.hpp>
+#endif
 #include "LoRaWANHandler.hpp"
 #include <App.hpp>
-#include <FS.h>
-#include <SPIFFS.h>
-#include <Preferences.h>
+#include <SpscQueue.hpp>
+#include <BinLog.hpp>
+#include <RenderPipeline.hpp>
+#include <Airtime.hpp>
+#include <LinkAdr.hpp>
+#include <SampleBuffer.hpp>
+#include <SessionStore.hpp>
+#include <SettingsStore.hpp>
+#include <UplinkScheduler.hpp>
+#include <Backlog.hpp>
+#include <ConfirmedUplink.hpp>
+#include <LinkStats.hpp>
+#include <RegionPlan.hpp>
+#if defined(DEEP_SLEEP_ENABLED) || defined(LIGHT_SLEEP_ENABLED)
+#include <esp_sleep.h>
+#endif
+#ifdef LIGHT_SLEEP_ENABLED
+#include <driver/gpio.h>
+#endif
 
 #define uS_TO_S_FACTOR 1000000
 
+#ifndef REGION_PLAN
+#error "no channel plan in lib/RegionPlan for the LMIC region"
+#endif
+
+// both would change data rate and TX power
+#if defined(LINK_ADR_ENABLED) && defined(ADR_ENABLED)
+#error "LINK_ADR_ENABLED and ADR_ENABLED exclude each other"
+#endif
+
+// resolved at compile time, no lookup at run time
+static constexpr const RegionPlan &regionPlan = REGION_PLAN;
+#ifdef CFG_eu868
+static_assert(REGION_BAND_MILLI == BAND_MILLI && REGION_BAND_CENTI == BAND_CENTI, "EU868 bands differ from LMIC");
+#endif
+
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE 16
+#endif
+
+// do not handle queued events if a time critical LMIC job is due within this time
+#ifndef EVENT_GUARD_TIME_MS
+#define EVENT_GUARD_TIME_MS 50
+#endif
+
+// light sleep only if the next LMIC job is at least this far away
+#ifndef LIGHT_SLEEP_MIN_MS
+#define LIGHT_SLEEP_MIN_MS 10
+#endif
+
+// wake up this early, covers the light sleep wake up latency
+#ifndef LIGHT_SLEEP_GUARD_MS
+#define LIGHT_SLEEP_GUARD_MS 2
+#endif
+
+// upper limit if LMIC has no job scheduled at all
+#ifndef LIGHT_SLEEP_MAX_MS
+#define LIGHT_SLEEP_MAX_MS 1000
+#endif
+
+// how long the TXCOMPLETE status stays visible before going to deep sleep
+#ifndef DISPLAY_HOLD_TIME_MS
+#ifdef DISPLAY_ENABLED
+#define DISPLAY_HOLD_TIME_MS 1000
+#else
+#define DISPLAY_HOLD_TIME_MS 0
+#endif
+#endif
+
 LoRaWANHandler loRaWANHandler;
 
 RTC_DATA_ATTR unsigned long rxFrameCounter = 0;
 
+// milliseconds spent before the last wake up, millis() restarts after deep sleep
+RTC_DATA_ATTR uint64_t rtcClockOffsetMs = 0;
+
+#ifdef AIRTIME_BUDGET_MS
+RTC_DATA_ATTR AirtimeBudget airtimeBudget;
+#endif
+
+#ifdef LINK_ADR_ENABLED
+RTC_DATA_ATTR LinkAdr linkAdr;
+RTC_DATA_ATTR uint8_t linkDataRate = regionPlan.fastestDataRate;
+RTC_DATA_ATTR int8_t linkTxPower = 14;
+#endif
+
+RTC_DATA_ATTR uint32_t transmitInterval = TRANSMIT_INTERVAL;
+
+RTC_DATA_ATTR uint16_t downlinksAccepted = 0;
+RTC_DATA_ATTR uint16_t downlinksRejected = 0;
+
+// telemetry, diagnostics and alarms share the LMIC TX queue
+RTC_DATA_ATTR UplinkScheduler uplinkScheduler;
+
+// while the link is down telemetry waits in the backlog
+RTC_DATA_ATTR bool linkDown = false;
+RTC_DATA_ATTR uint8_t missedAcks = 0;
+RTC_DATA_ATTR uint8_t parkedSinceProbe = 0;
+
+RTC_DATA_ATTR ConfirmedUplink confirmedUplink;
+
+RTC_DATA_ATTR LinkStats linkStats;
+RTC_DATA_ATTR uint32_t lastDiagnosticsAt = 0;
+
 int bwf[] = {125, 250, 500, 750};
 
 #ifdef ACTIVATION_MODE_OTAA
@@ -69,8 +166,6 @@ void os_getDevKey(u1_t *buf) { memcpy_P(buf, APPKEY, 16); }
 #endif
 
 #ifdef ACTIVATION_MODE_ABP
-static Preferences preferences;
-
 static uint8_t NETWORK_SESSION_KEY[16] = TTN_NETWORK_SESSION_KEY;
 static uint8_t APP_SESSION_KEY[16] = TTN_APP_SESSION_KEY;
 static u4_t DEVADDR = TTN_DEVICE_ADDRESS;
@@ -82,6 +177,48 @@ void os_getDevKey(u1_t *buf) {}
 
 // static uint8_t mydata[64];
 static osjob_t sendjob;
+#ifdef SAMPLE_INTERVAL
+static osjob_t samplejob;
+#endif
+#ifdef DEEP_SLEEP_ENABLED
+static osjob_t sleepjob;
+#else
+static unsigned long lastCycleStart = 0;
+static unsigned long lastCycleSleptMs = 0;
+#endif
+
+// time spent in light sleep since boot
+static unsigned long sleptMs = 0;
+
+static bool firstTxStarted = false;
+
+// of the last EV_TXSTART, a retransmission costs the same
+static uint32_t lastAirtimeUs = 0;
+// of all EV_TXSTART since the last EV_TXCOMPLETE, LMIC repeats confirmed frames
+static uint32_t uplinkAirtimeUs = 0;
+// of the last EV_TXSTART, at EV_TXCOMPLETE LMIC.rps and LMIC.freq are those of the last RX window
+static rps_t uplinkRps = 0;
+static uint32_t uplinkFreq = 0;
+
+#ifndef LMIC_USE_INTERRUPTS
+// LMIC polls the DIO lines and only sees an edge on its next run loop pass
+static volatile uint32_t dio0EdgeUs = 0;
+static volatile uint32_t dio1EdgeUs = 0;
+#endif
+
+static SpscQueue<LoRaWANEvent, EVENT_QUEUE_SIZE> eventQueue;
+static LoRaWANEventStatistics eventStatistics;
+static RxTiming rxTiming;
+
+struct EventTableEntry
+{
+    LoRaWANEventHandler handler; // built in
+    LoRaWANEventHandler hook;    // optional, set by the application
+    LoRaWANHandlerProfile profile;
+};
+
+// indexed by ev_t
+static EventTableEntry eventTable[LORAWAN_EVENT_COUNT];
 
 const lmic_pinmap lmic_pins = {
     .nss = LMIC_NSS,
@@ -89,280 +226,1281 @@ const lmic_pinmap lmic_pins = {
     .rst = LMIC_RST,
     .dio = {LMIC_DIO0, LMIC_DIO1, LMIC_DIO2}};
 
-void printHex2(unsigned v)
+static uint32_t clockSeconds()
 {
-    v &= 0xff;
-    if (v < 16)
-        SERIAL_PRINT('0');
-    SERIAL_PRINTB(v, HEX);
+    return (rtcClockOffsetMs + millis()) / 1000;
 }
 
-void do_send(osjob_t *j)
+static uint32_t rpsAirtimeUs(rps_t rps, uint8_t length)
 {
-    // Check if there is not a current TX/RX job running
-    if (LMIC.opmode & OP_TXRXPEND)
+    return airtimeUs(getSf(rps) + 6, bwf[getBw(rps)] * 1000UL, getCr(rps) + 1,
+                     length, !getNocrc(rps), getIh(rps) != 0);
+}
+
+// slowest uplink data rate of the region if the spreading factor is not available
+static dr_t spreadingFactorDataRate(uint8_t spreadingFactor)
+{
+    int dataRate = regionPlan.fastestDataRate + 7 - spreadingFactor;
+    return dataRate < regionPlan.slowestDataRate ? regionPlan.slowestDataRate : dataRate;
+}
+
+static uint8_t maxPayloadSize(uint8_t dataRate)
+{
+    return regionPlan.maxPayload[dataRate % REGION_DATA_RATES];
+}
+
+// application payload of the next uplink, the MAC answers LMIC sends in
+// FOpts count against the maximum payload
+static uint8_t uplinkPayloadSize()
+{
+    uint8_t size = maxPayloadSize(LMIC.datarate);
+    return LMIC.pendMacLen < size ? size - LMIC.pendMacLen : 0;
+}
+
+#ifdef ACTIVATION_MODE_ABP
+// channels or sub-band and RX2 of the region, a joined session gets them from the network
+static void applyRegionPlan()
+{
+    for (uint8_t channel = 0; channel < regionPlan.channelCount; channel++)
     {
-        SERIAL_PRINTLN(F("OP_TXRXPEND, not sending"));
+        const RegionChannel &plan = regionPlan.channels[channel];
+        LMIC_setupChannel(channel, plan.frequency, DR_RANGE_MAP(plan.minDataRate, plan.maxDataRate), plan.band);
     }
-    else
+#if CFG_LMIC_US_like
+    LMIC_selectSubBand(regionPlan.subBand);
+#endif
+    LMIC.dn2Dr = regionPlan.rx2DataRate;
+    LMIC.dn2Freq = regionPlan.rx2Frequency;
+}
+#endif
+
+// telemetry follows transmitInterval, which the airtime budget stretches
+static void configureStreams()
+{
+    UplinkStreamConfig telemetry = {TELEMETRY_PORT, 1, transmitInterval, 0};
+    UplinkStreamConfig diagnostics = {DIAGNOSTICS_PORT, 2, 0, DIAGNOSTICS_DEADLINE};
+    UplinkStreamConfig alarm = {ALARM_PORT, 0, 0, 0};
+
+    uplinkScheduler.configure(STREAM_TELEMETRY, telemetry);
+    uplinkScheduler.configure(STREAM_DIAGNOSTICS, diagnostics);
+    uplinkScheduler.configure(STREAM_ALARM, alarm);
+}
+
+static void setLinkDown(bool down)
+{
+    if (down == linkDown)
     {
-        lora_send(LMIC.seqnoUp);
+        return;
     }
-    // Next TX is scheduled after TX_COMPLETE event.
+    linkDown = down;
+    parkedSinceProbe = 0;
+    BINLOG(LINK_STATE, down, missedAcks, backlog.count());
 }
 
-void onEvent(ev_t ev)
+static void parkTelemetry(uint32_t storedAt, const uint8_t *data, uint8_t length)
 {
-    SERIAL_PRINT(os_getTime());
-    SERIAL_PRINT(": ");
-    switch (ev)
-    {
-    case EV_SCAN_TIMEOUT:
-        SERIAL_PRINTLN(F("EV_SCAN_TIMEOUT"));
-        break;
+    backlog.push(storedAt, data, length);
+    BINLOG(BACKLOG_STORED, backlog.count(), backlog.getFlashCount(), backlog.getStatistics().dropped);
+}
 
-    case EV_BEACON_FOUND:
-        SERIAL_PRINTLN(F("EV_BEACON_FOUND"));
-        break;
+// While the link is down telemetry goes to the backlog, except every
+// BACKLOG_PROBE_INTERVAL-th payload. An unsent reading is parked
+// instead of being overwritten.
+static bool submitTelemetry(const uint8_t *data, uint8_t length, uint32_t now)
+{
+    uint8_t unsent[UPLINK_STREAM_PAYLOAD_SIZE];
+    uint8_t unsentLength;
+    uint32_t unsentAt;
+    bool parking = linkDown && ++parkedSinceProbe < BACKLOG_PROBE_INTERVAL;
 
-    case EV_BEACON_MISSED:
-        SERIAL_PRINTLN(F("EV_BEACON_MISSED"));
-        break;
+#ifdef SAMPLE_INTERVAL
+    // the new batch takes the readings of the unsent one again
+    if (parking)
+    {
+        uplinkScheduler.withdraw(STREAM_TELEMETRY, unsent, unsentLength, unsentAt);
+    }
+#else
+    if (uplinkScheduler.withdraw(STREAM_TELEMETRY, unsent, unsentLength, unsentAt))
+    {
+        parkTelemetry(unsentAt, unsent, unsentLength);
+    }
+#endif
 
-    case EV_BEACON_TRACKED:
-        SERIAL_PRINTLN(F("EV_BEACON_TRACKED"));
-        break;
+    if (!parking)
+    {
+        parkedSinceProbe = 0;
+        return uplinkScheduler.submit(STREAM_TELEMETRY, data, length, now);
+    }
 
-    case EV_JOINING:
-        SERIAL_PRINTLN(F("EV_JOINING"));
-        DISPLAY_STATUS("JOINING");
-        break;
+    parkTelemetry(now, data, length);
+    uplinkScheduler.skip(STREAM_TELEMETRY, now);
+#ifdef SAMPLE_INTERVAL
+    // the readings live in the backlog now
+    sampleBuffer.commit();
+#endif
+    return true;
+}
 
-    case EV_JOINED:
+// One backlog payload at a time, as soon as the duty cycle and the
+// airtime budget allow. Called when the previous uplink is complete.
+static void drainBacklog()
+{
+    if (linkDown || backlog.empty() || uplinkScheduler.isPending(STREAM_BACKLOG))
     {
-        u4_t netid = 0;
-        devaddr_t devaddr = 0;
-        u1_t nwkKey[16];
-        u1_t artKey[16];
-        LMIC_getSessionKeys(&netid, &devaddr, nwkKey, artKey);
+        return;
+    }
 
-#if defined(BUILTIN_LED) && defined(BUILTIN_LED_ENABLED)
-        digitalWrite(BUILTIN_LED, HIGH);
+    uint32_t now = clockSeconds();
+    BacklogEntry entry;
+    if (!backlog.pop(now, entry))
+    {
+        return;
+    }
+
+    uint32_t deadline = 0;
+#ifdef AIRTIME_BUDGET_MS
+    uint32_t airtime = rpsAirtimeUs(updr2rps(LMIC.datarate), LORAWAN_FRAME_OVERHEAD + entry.length);
+    deadline = airtimeBudget.nextInterval(now, airtime, 0);
 #endif
+    UplinkStreamConfig config = {BACKLOG_PORT, 3, 0, deadline};
+    uplinkScheduler.configure(STREAM_BACKLOG, config);
+    uplinkScheduler.submit(STREAM_BACKLOG, entry.data, entry.length, now);
+    BINLOG(BACKLOG_DRAINED, backlog.getStatistics().lastWait, backlog.count(), deadline);
+}
 
-#ifdef DISPLAY_ENABLED
-        display.drawString(0, 12, "JOINED");
-        display.display();
+// No ack after LMIC's own repetitions, send the payloads again after the
+// backoff, or later if the airtime budget is used up.
+static void retryUplink(uint32_t backoff)
+{
+    uint32_t now = clockSeconds();
+#ifdef AIRTIME_BUDGET_MS
+    uint32_t wait = airtimeBudget.nextInterval(now, lastAirtimeUs, 0);
+    if (wait > backoff)
+    {
+        backoff = wait;
+    }
 #endif
+    uplinkScheduler.retry(now, backoff);
+}
 
-#ifdef SERIAL_ENABLED
-        SERIAL_PRINTLN(F("EV_JOINED"));
-        SERIAL_PRINT("netid: ");
-        SERIAL_PRINTLNB(netid, DEC);
-        SERIAL_PRINT("devaddr: ");
-        SERIAL_PRINTLNB(devaddr, HEX);
-        SERIAL_PRINT("AppSKey: ");
-        for (size_t i = 0; i < sizeof(artKey); ++i)
-        {
-            if (i != 0)
-                SERIAL_PRINT("-");
-            printHex2(artKey[i]);
-        }
-        SERIAL_PRINTLN("");
-        SERIAL_PRINT("NwkSKey: ");
-        for (size_t i = 0; i < sizeof(nwkKey); ++i)
+// Takes the streams' payloads back from the scheduler, telemetry and
+// backlog payloads wait in the backlog, the others are dropped.
+static void parkStreams(uint8_t streams)
+{
+    for (uint8_t stream = 0; stream < UPLINK_STREAMS; stream++)
+    {
+        uint8_t data[UPLINK_STREAM_PAYLOAD_SIZE];
+        uint8_t length;
+        uint32_t submittedAt;
+        if ((streams & (1 << stream)) && uplinkScheduler.withdraw(stream, data, length, submittedAt) &&
+            (stream == STREAM_TELEMETRY || stream == STREAM_BACKLOG))
         {
-            if (i != 0)
-                SERIAL_PRINT("-");
-            printHex2(nwkKey[i]);
+            parkTelemetry(submittedAt, data, length);
         }
-        SERIAL_PRINTLN();
-#endif
+    }
+}
 
-        // Disable link check validation (automatically enabled
-        // during join, but because slow data rates change max TX
-        // size, we don't use it in this example.
-        LMIC_setLinkCheckMode(0);
+// the payloads are not sent again, telemetry waits in the backlog
+static void giveUpUplink()
+{
+    uint8_t streams = uplinkScheduler.getInFlight();
+    uplinkScheduler.canceled();
+    parkStreams(streams);
+}
+
+static void queueDiagnostics()
+{
+    Diagnostics diagnostics = {};
+    diagnostics.uptime = clockSeconds();
+    diagnostics.downlinksAccepted = downlinksAccepted;
+    diagnostics.downlinksRejected = downlinksRejected;
+    diagnostics.eventsDropped = eventStatistics.dropped > UINT16_MAX ? UINT16_MAX : eventStatistics.dropped;
+    diagnostics.flashCommits = sessionStore.getCommits() > UINT16_MAX ? UINT16_MAX : sessionStore.getCommits();
+    int32_t jitter = rxTiming.getStatistics(0).maxJitterUs;
+    diagnostics.rx1JitterUs = jitter > INT16_MAX ? INT16_MAX : (jitter < INT16_MIN ? INT16_MIN : jitter);
+
+    // report what LMIC uses, the network may have changed it
+    DeviceSettings settings = settingsStore.get();
+    settings.adr = LMIC.adrEnabled ? 1 : 0;
+
+    uint8_t data[DIAGNOSTICS_SIZE];
+    size_t length = downlinkEncodeDiagnostics(data, sizeof(data), settings, diagnostics, linkStats.getSnapshot());
+    if (uplinkScheduler.submit(STREAM_DIAGNOSTICS, data, length, clockSeconds()))
+    {
+        lastDiagnosticsAt = clockSeconds();
+    }
+    BINLOG(DIAGNOSTICS_QUEUED, length);
+}
+
+// bring LMIC, the schedule and the display in line with changed settings
+static void applySettings(const DeviceSettings &settings, uint8_t changed)
+{
+    if (changed & DOWNLINK_CHANGED_INTERVAL)
+    {
+        // with AIRTIME_BUDGET_MS the next EV_TXSTART may stretch it
+        transmitInterval = settings.interval;
+        configureStreams();
     }
-    break;
 
-    case EV_JOIN_FAILED:
-        SERIAL_PRINTLN(F("EV_JOIN_FAILED"));
-        DISPLAY_ERROR("JOIN_FAILED");
-        break;
+#ifndef LINK_ADR_ENABLED
+    // with the device side tracker LMIC ADR stays off
+    if (changed & DOWNLINK_CHANGED_ADR)
+    {
+        LMIC_setAdrMode(settings.adr);
+    }
+#endif
 
-    case EV_REJOIN_FAILED:
-        SERIAL_PRINTLN(F("EV_REJOIN_FAILED"));
-        DISPLAY_ERROR("REJOIN_FAILED");
-        break;
+    if (changed & DOWNLINK_CHANGED_DATA_RATE)
+    {
+        LMIC_setDrTxpow(spreadingFactorDataRate(settings.spreadingFactor), settings.txPower);
+#ifdef LINK_ADR_ENABLED
+        linkDataRate = LMIC.datarate;
+        linkTxPower = settings.txPower;
+#endif
+    }
 
-    case EV_TXCOMPLETE:
-        SERIAL_PRINTLN(F("EV_TXCOMPLETE (includes waiting for RX windows)"));
 #ifdef DISPLAY_ENABLED
-        display.clear();
+    // setup() of a running display would race the render task for the buffer and I2C
+    if (changed & DOWNLINK_CHANGED_DISPLAY)
+    {
+        if (settings.display && !displayHandler.isActive())
+        {
+            displayHandler.setup();
+        }
+        else if (!settings.display && displayHandler.isActive())
+        {
+            displayHandler.sleep();
+        }
+    }
+#endif
+}
+
+static bool telemetryDue(uint32_t now)
+{
+    if (!uplinkScheduler.isDue(STREAM_TELEMETRY, now))
+    {
+        return false;
+    }
+#ifdef SAMPLE_INTERVAL
+    return sampleBuffer.count() >= loRaWANHandler.batchSize();
+#else
+    return true;
 #endif
-        if (LMIC.txrxFlags & TXRX_ACK)
-            SERIAL_PRINTLN(F("Received ack"));
+}
 
-        SERIAL_PRINTF("RSSI: %d\n", (int)LMIC.rssi);
-        SERIAL_PRINTF("SNR: %d\n", (int)LMIC.snr);
-        SERIAL_PRINTF("SF: %d\n", (LMIC.rps & 0x07) + 6);
-        SERIAL_PRINTF("BW: %d\n", bwf[(LMIC.rps >> 3) & 0x03]);
+// Produce the telemetry if it is due and hand the most urgent payloads to
+// LMIC. False if nothing is pending or the duty cycle does not allow it yet.
+static bool sendNow()
+{
+    uint32_t now = clockSeconds();
+    if (telemetryDue(now))
+    {
+        lora_send(LMIC.seqnoUp);
+    }
+#if DIAGNOSTICS_INTERVAL > 0
+    // rides along with this uplink, or goes out alone at its deadline
+    if (now - lastDiagnosticsAt >= DIAGNOSTICS_INTERVAL && !uplinkScheduler.isPending(STREAM_DIAGNOSTICS))
+    {
+        queueDiagnostics();
+    }
+#endif
 
-        if (LMIC.dataLen)
+    uint8_t data[UPLINK_STREAMS * (UPLINK_COALESCED_HEADER + UPLINK_STREAM_PAYLOAD_SIZE)];
+    uint8_t port;
+    uint8_t deferred = uplinkScheduler.getDeferred();
+    uint8_t size = uplinkPayloadSize();
+    size_t length = uplinkScheduler.build(now, size, port, data);
+    for (uint8_t stream = 0; stream < UPLINK_STREAMS; stream++)
+    {
+        if (uplinkScheduler.getDeferred() & ~deferred & (1 << stream))
         {
-            rxFrameCounter++;
-            lora_receive(rxFrameCounter);
+            BINLOG(UPLINK_DEFERRED, stream, size, uplinkScheduler.getStatistics(stream).deferred);
         }
+    }
+    if (length == 0)
+    {
+        return false;
+    }
 
-#ifdef DISPLAY_ENABLED
-        display.drawString(0, 0, "TXCOMPLETE");
-        char buf[32];
-        sprintf(buf, "TXC: %d", (LMIC.seqnoUp-1));
-        display.drawString(0, 12, buf);
-        sprintf(buf, "RXC: %ld (%d)", rxFrameCounter, LMIC.dataLen);
-        display.drawString(52, 12, buf);
-        sprintf(buf, "RSSI: %d", (int)LMIC.rssi);
-        display.drawString(0, 24, buf);
-#ifdef ADC_PIN
-        sprintf(buf, "BAT: %.02fV\n", analogRead(ADC_PIN) * 6.6 / 4095.0);
-        display.drawString(52, 24, buf);
+#ifdef CONFIRMED_ALARMS
+    bool critical = (uplinkScheduler.getInFlight() & (1 << STREAM_ALARM)) != 0;
+#else
+    bool critical = false;
 #endif
-        sprintf(buf, "SNR: %u", LMIC.snr);
-        display.drawString(0, 36, buf);
-        sprintf(buf, "SF: %u", (LMIC.rps & 0x07) + 6);
-        display.drawString(52, 36, buf);
-        sprintf(buf, "BW: %u", bwf[(LMIC.rps >> 3) & 0x03]);
-        display.drawString(88, 36, buf);
+    bool confirmed = confirmedUplink.request(critical);
 
-        sprintf(buf, "FREQ: %u", LMIC.freq);
-        display.drawString(0, 48, buf);
-        display.display();
-        delay(1000);
-#endif
+    if (LMIC_setTxData2(port, data, length, confirmed) != 0)
+    {
+        uplinkScheduler.canceled();
+        return false;
+    }
+    BINLOG(UPLINK_QUEUED, port, length, confirmed);
+    return true;
+}
 
-#ifdef ACTIVATION_MODE_ABP
-        preferences.putUInt(SEQUENCE_KEY, LMIC.seqnoUp);
-        SERIAL_PRINTF( "TXC " SEQUENCE_KEY "=%u\n", LMIC.seqnoUp);
+void do_send(osjob_t *j);
+#ifdef DEEP_SLEEP_ENABLED
+static void do_sleep(osjob_t *j);
 #endif
 
+#ifndef SAMPLE_INTERVAL
+// the next uplink when a stream needs one, with SAMPLE_INTERVAL do_sample() sends
+static void scheduleSend()
+{
 #ifdef DEEP_SLEEP_ENABLED
-        ESP.deepSleep(TRANSMIT_INTERVAL * uS_TO_S_FACTOR);
-        yield();
+    os_setCallback(&sleepjob, do_sleep);
 #else
-        // Schedule next transmission
-        os_setTimedCallback(&sendjob, os_getTime() + sec2osticks(TRANSMIT_INTERVAL), do_send);
+    uint32_t next = uplinkScheduler.nextUplink(clockSeconds());
+    if (next == UPLINK_NONE)
+    {
+        next = transmitInterval;
+    }
+    else if (next == 0)
+    {
+        // due but not sent, do_send() must not run again right away
+        next = 1;
+    }
+    os_setTimedCallback(&sendjob, os_getTime() + sec2osticks(next), do_send);
+#endif
+}
 #endif
-        break;
 
-    case EV_LOST_TSYNC:
-        SERIAL_PRINTLN(F("EV_LOST_TSYNC"));
-        DISPLAY_ERROR("LOST_TSYNC");
-        break;
+void do_send(osjob_t *j)
+{
+    // Check if there is not a current TX/RX job running
+    if (LMIC.opmode & OP_TXRXPEND)
+    {
+        BINLOG(NOT_SENDING);
+        return;
+    }
 
-    case EV_RESET:
-        SERIAL_PRINTLN(F("EV_RESET"));
-        DISPLAY_ERROR("RESET");
-        break;
+    if (!sendNow())
+    {
+#ifndef SAMPLE_INTERVAL
+        scheduleSend();
+#endif
+    }
+    // Next TX is scheduled after TX_COMPLETE event.
+}
 
-    case EV_RXCOMPLETE:
-        // data received in ping slot
-        SERIAL_PRINTLN(F("EV_RXCOMPLETE"));
-        break;
+#ifdef DEEP_SLEEP_ENABLED
+static void do_sleep(osjob_t *j)
+{
+#ifdef SAMPLE_INTERVAL
+    uint32_t sleepInterval = SAMPLE_INTERVAL;
+#else
+    uint32_t sleepInterval = uplinkScheduler.nextUplink(clockSeconds());
+    if (sleepInterval == UPLINK_NONE)
+    {
+        sleepInterval = transmitInterval;
+    }
+    else if (sleepInterval == 0)
+    {
+        // due now, but the LMIC job queue is left behind
+        sleepInterval = 1;
+    }
+#endif
 
-    case EV_LINK_DEAD:
-        SERIAL_PRINTLN(F("EV_LINK_DEAD"));
-        DISPLAY_ERROR("LINK_DEAD");
-        break;
+    // millis() starts at 0 after every wake up
+    BINLOG(CYCLE_TIME, millis() + sleepInterval * 1000UL, millis());
+    binLog.flush();
+#ifdef DISPLAY_ENABLED
+    displayHandler.sleep();
+#endif
+    rtcClockOffsetMs += millis() + sleepInterval * 1000ULL;
+    ESP.deepSleep((uint64_t)sleepInterval * uS_TO_S_FACTOR);
+    yield();
+}
+#endif
 
-    case EV_LINK_ALIVE:
-        SERIAL_PRINTLN(F("EV_LINK_ALIVE"));
-        DISPLAY_STATUS("LINK_ALIVE");
-        break;
+#ifdef SAMPLE_INTERVAL
+static void do_sample(osjob_t *j)
+{
+    lora_sample();
 
-    case EV_TXSTART:
-        SERIAL_PRINTLN(F("EV_TXSTART"));
-        DISPLAY_STATUS("TXSTART");
-        SERIAL_PRINTF("RSSI: %d\n", (int)LMIC.rssi);
-        SERIAL_PRINTF("SNR: %d\n", (int)LMIC.snr);
-        SERIAL_PRINTF("SF: %d\n", (LMIC.rps & 0x07) + 6);
-        break;
+    uint32_t now = clockSeconds();
+    bool sending = false;
 
-    case EV_TXCANCELED:
-        SERIAL_PRINTLN(F("EV_TXCANCELED"));
-        DISPLAY_ERROR("TXCANCELED");
-        break;
+    // full batch, or another stream's payload at its deadline
+    if (!(LMIC.opmode & OP_TXRXPEND) && (telemetryDue(now) || uplinkScheduler.nextUplink(now) == 0))
+    {
+        sending = sendNow();
+    }
 
-    case EV_RXSTART:
-        /* do not print anything -- it wrecks timing */
-        break;
+#ifdef DEEP_SLEEP_ENABLED
+    // after an uplink EV_TXCOMPLETE sends the node to sleep
+    if (!sending)
+    {
+        os_setCallback(&sleepjob, do_sleep);
+    }
+#else
+    (void)sending;
+    os_setTimedCallback(&samplejob, os_getTime() + sec2osticks(SAMPLE_INTERVAL), do_sample);
+#endif
+}
+#endif
 
-    case EV_JOIN_TXCOMPLETE:
-        SERIAL_PRINTLN(F("EV_JOIN_TXCOMPLETE: no JoinAccept"));
-        DISPLAY_STATUS("NO JOIN ACCEPTED");
-        break;
+#ifndef LMIC_USE_INTERRUPTS
+static void IRAM_ATTR onDio0Edge()
+{
+    dio0EdgeUs = micros();
+}
 
-    default:
-        SERIAL_PRINT(F("Unknown event: "));
-        SERIAL_PRINTLN((unsigned)ev);
-        break;
-    }
+static void IRAM_ATTR onDio1Edge()
+{
+    dio1EdgeUs = micros();
 }
+#endif
 
-void LoRaWANHandler::setup()
+// LMIC callback, only records the event. It is handled by
+// LoRaWANHandler::processEvents() outside of the LMIC run loop.
+void onEvent(ev_t ev)
 {
-#ifdef VCC_ENABLE
-    // For Pinoccio Scout boards
-    pinMode(VCC_ENABLE, OUTPUT);
-    digitalWrite(VCC_ENABLE, HIGH);
-    delay(1000);
+    LoRaWANEvent event;
+    event.ev = ev;
+    event.timestamp = os_getTime();
+    event.enqueuedUs = micros();
+    event.freq = LMIC.freq;
+    event.seqnoUp = LMIC.seqnoUp;
+    event.rssi = LMIC.rssi;
+    event.snr = LMIC.snr;
+    event.rps = LMIC.rps;
+    event.dataLen = LMIC.dataLen;
+    event.txrxFlags = LMIC.txrxFlags;
+    event.txend = LMIC.txend;
+    event.rxtime = LMIC.rxtime;
+#ifdef LMIC_USE_INTERRUPTS
+    event.dio0Us = 0;
+    event.dio1Us = 0;
+#else
+    event.dio0Us = dio0EdgeUs;
+    event.dio1Us = dio1EdgeUs;
 #endif
 
-    // LMIC init
-    os_init();
-    // Reset the MAC state. Session and pending data transfers will be discarded.
-    LMIC.rssi = 0;
-    LMIC_reset();
+    if (eventQueue.push(event))
+    {
+        eventStatistics.enqueued++;
+    }
+    else
+    {
+        eventStatistics.dropped++;
+    }
+}
 
-#ifdef ACTIVATION_MODE_ABP
-    LMIC_setSession(0x13, DEVADDR, NETWORK_SESSION_KEY, APP_SESSION_KEY);
+// Built-in handlers, one per LMIC event. They run from processEvents(),
+// user hooks registered with setEventHook() run right after them.
 
-    LMIC_setupChannel(0, 868100000, DR_RANGE_MAP(DR_SF12, DR_SF7), BAND_CENTI);  // g-band
-    LMIC_setupChannel(1, 868300000, DR_RANGE_MAP(DR_SF12, DR_SF7B), BAND_CENTI); // g-band
-    LMIC_setupChannel(2, 868500000, DR_RANGE_MAP(DR_SF12, DR_SF7), BAND_CENTI);  // g-band
-    LMIC_setupChannel(3, 867100000, DR_RANGE_MAP(DR_SF12, DR_SF7), BAND_CENTI);  // g-band
-    LMIC_setupChannel(4, 867300000, DR_RANGE_MAP(DR_SF12, DR_SF7), BAND_CENTI);  // g-band
-    LMIC_setupChannel(5, 867500000, DR_RANGE_MAP(DR_SF12, DR_SF7), BAND_CENTI);  // g-band
-    LMIC_setupChannel(6, 867700000, DR_RANGE_MAP(DR_SF12, DR_SF7), BAND_CENTI);  // g-band
-    LMIC_setupChannel(7, 867900000, DR_RANGE_MAP(DR_SF12, DR_SF7), BAND_CENTI);  // g-band
-    LMIC_setupChannel(8, 868800000, DR_RANGE_MAP(DR_FSK, DR_FSK), BAND_MILLI);   // g2-band  // LMIC_setClockError(7);
+static void onRxStart(const LoRaWANEvent &event)
+{
+    // Reported when the RX job runs. LMIC schedules it the radio's ramp-up
+    // ahead of rxtime, the radio then waits for rxtime itself.
+    uint8_t window = (event.txrxFlags & TXRX_DNW2) ? 1 : 0;
+    uint32_t scheduledUs = osticks2us(event.rxtime - os_getRadioRxRampup());
+    rxTiming.windowOpened(window, osticks2us(event.txend), scheduledUs, osticks2us(event.timestamp));
+    BINLOG(RX_TIMING, window + 1, (uint32_t)osticks2us(event.txend), scheduledUs,
+           (uint32_t)osticks2us(event.timestamp), event.dio0Us, event.dio1Us);
+}
 
-    // Disable link check validation
-    LMIC_setLinkCheckMode(0);
+static void onScanTimeout(const LoRaWANEvent &event)
+{
+    BINLOG(EV_SCAN_TIMEOUT, event.timestamp);
+}
+
+static void onBeaconFound(const LoRaWANEvent &event)
+{
+    BINLOG(EV_BEACON_FOUND, event.timestamp);
+}
 
-    // TTN uses SF9 for its RX2 window.
-    LMIC.dn2Dr = DR_SF9;
+static void onBeaconMissed(const LoRaWANEvent &event)
+{
+    BINLOG(EV_BEACON_MISSED, event.timestamp);
+}
 
-    // Set data rate and transmit power for uplink
-    LMIC_setDrTxpow(DR_SF7, 14);
-#endif
+static void onBeaconTracked(const LoRaWANEvent &event)
+{
+    BINLOG(EV_BEACON_TRACKED, event.timestamp);
 }
 
-void LoRaWANHandler::runOnce()
+static void onJoining(const LoRaWANEvent &event)
 {
-    os_runloop_once();
+    BINLOG(EV_JOINING, event.timestamp);
+    DISPLAY_STATUS("JOINING");
 }
 
-void LoRaWANHandler::start()
+static void onJoined(const LoRaWANEvent &event)
 {
-#ifdef ACTIVATION_MODE_ABP
-    preferences.begin(PREFERENCE_NAME);
-    LMIC.seqnoUp = preferences.getUInt(SEQUENCE_KEY);
-    preferences.putUInt(SEQUENCE_KEY, LMIC.seqnoUp);
-    SERIAL_PRINTF(SEQUENCE_KEY "=%u\n", LMIC.seqnoUp);
+    u4_t netid = 0;
+    devaddr_t devaddr = 0;
+    u1_t nwkKey[16];
+    u1_t artKey[16];
+    LMIC_getSessionKeys(&netid, &devaddr, nwkKey, artKey);
+
+#if defined(BUILTIN_LED) && defined(BUILTIN_LED_ENABLED)
+    digitalWrite(BUILTIN_LED, HIGH);
 #endif
 
-    do_send(&sendjob);
+#ifdef DISPLAY_ENABLED
+    {
+        StatusSnapshot snapshot = {};
+        snapshot.kind = SNAPSHOT_JOINED;
+        displayHandler.show(snapshot);
+    }
+#endif
+
+    BINLOG(EV_JOINED, event.timestamp);
+    BINLOG(JOINED_NETID, netid);
+    BINLOG(JOINED_DEVADDR, devaddr);
+    BINLOG(JOINED_APPSKEY, artKey[0], artKey[1], artKey[2], artKey[3],
+           artKey[4], artKey[5], artKey[6], artKey[7]);
+    BINLOG(JOINED_KEY_END, artKey[8], artKey[9], artKey[10], artKey[11],
+           artKey[12], artKey[13], artKey[14], artKey[15]);
+    BINLOG(JOINED_NWKSKEY, nwkKey[0], nwkKey[1], nwkKey[2], nwkKey[3],
+           nwkKey[4], nwkKey[5], nwkKey[6], nwkKey[7]);
+    BINLOG(JOINED_KEY_END, nwkKey[8], nwkKey[9], nwkKey[10], nwkKey[11],
+           nwkKey[12], nwkKey[13], nwkKey[14], nwkKey[15]);
+
+    // Disable link check validation (automatically enabled
+    // during join, but because slow data rates change max TX
+    // size, we don't use it in this example.
+    LMIC_setLinkCheckMode(0);
+
+    // the next wake up or power on continues this session
+    sessionStore.saveSession(true);
+    BINLOG(SESSION_SAVED, devaddr, sessionStore.getJoins());
+}
+
+static void onJoinFailed(const LoRaWANEvent &event)
+{
+    BINLOG(EV_JOIN_FAILED, event.timestamp);
+    DISPLAY_ERROR("JOIN_FAILED");
+}
+
+static void onRejoinFailed(const LoRaWANEvent &event)
+{
+    BINLOG(EV_REJOIN_FAILED, event.timestamp);
+    DISPLAY_ERROR("REJOIN_FAILED");
+}
+
+// the most expensive handler so far, by maximum cycles
+static void logSlowestHandler()
+{
+    uint8_t slowest = 0;
+    for (uint8_t ev = 1; ev < LORAWAN_EVENT_COUNT; ev++)
+    {
+        if (eventTable[ev].profile.maxCycles > eventTable[slowest].profile.maxCycles)
+        {
+            slowest = ev;
+        }
+    }
+
+    const LoRaWANHandlerProfile &profile = eventTable[slowest].profile;
+    if (profile.calls > 0)
+    {
+        BINLOG(HANDLER_PROFILE, slowest, profile.maxCycles, (uint32_t)(profile.sumCycles / profile.calls));
+    }
+}
+
+static void onTxComplete(const LoRaWANEvent &event)
+{
+    BINLOG(EV_TXCOMPLETE, event.timestamp);
+#ifdef BINLOG_ENABLED
+    BINLOG(LOG_CYCLES, binLog.endWindow(), binLog.getStatistics().dropped);
+#endif
+    if (event.txrxFlags & TXRX_ACK)
+        BINLOG(RECEIVED_ACK);
+
+    BINLOG(LINK_STATUS, (int)event.rssi, (int)event.snr, getSf(uplinkRps) + 6);
+    BINLOG(BANDWIDTH, bwf[getBw(uplinkRps)]);
+
+    BINLOG(RX_JITTER, rxTiming.getStatistics(0).maxJitterUs, rxTiming.getStatistics(1).maxJitterUs,
+           rxTiming.suggestedClockError());
+    logSlowestHandler();
+
+    bool acked = (event.txrxFlags & TXRX_ACK) != 0;
+    bool ackRequested = confirmedUplink.isRequested();
+    {
+        LinkSample sample = {uplinkAirtimeUs, event.rssi, event.snr, (uint8_t)(getSf(uplinkRps) + 6), 0};
+        sample.flags = (ackRequested ? LINK_ACK_REQUESTED : 0) | (acked ? LINK_ACKED : 0) |
+                       (event.txrxFlags & TXRX_DNW1 ? LINK_RX1 : 0) | (event.txrxFlags & TXRX_DNW2 ? LINK_RX2 : 0);
+        linkStats.update(sample);
+        uplinkAirtimeUs = 0;
+
+        const LinkStatsSnapshot &link = linkStats.getSnapshot();
+        BINLOG(LINK_STATS, link.uplinks, link.rx1 + link.rx2, LinkStats::meanRssi(link), LinkStats::meanSnr(link),
+               LinkStats::ackRate(link), LinkStats::meanAirtimeUs(link) / 1000);
+    }
+    uint32_t backoff = 0;
+    ConfirmedResult confirmed = confirmedUplink.completed(acked, backoff);
+    if (ackRequested)
+    {
+        BINLOG(CONFIRMED, confirmed, confirmedUplink.getAckRate(), backoff);
+    }
+
+    // before lora_receive(), a downlink may queue the next payload
+    if (confirmed == CONFIRMED_RETRY)
+    {
+        retryUplink(backoff);
+    }
+    else if (confirmed == CONFIRMED_GIVE_UP)
+    {
+        giveUpUplink();
+    }
+    else
+    {
+        uplinkScheduler.completed();
+        for (uint8_t stream = 0; stream < UPLINK_STREAMS; stream++)
+        {
+            if (uplinkScheduler.getLastSent() & (1 << stream))
+            {
+                const UplinkStreamStatistics &statistics = uplinkScheduler.getStatistics(stream);
+                BINLOG(UPLINK_SENT, stream, statistics.lastDelay, statistics.maxDelay);
+            }
+        }
+    }
+
+    if (event.dataLen)
+    {
+        rxFrameCounter++;
+        lora_receive(rxFrameCounter);
+    }
+
+#ifdef SAMPLE_INTERVAL
+    // a retransmission still carries the pending readings
+    if (confirmed != CONFIRMED_RETRY)
+    {
+        sampleBuffer.commit();
+    }
+#endif
+
+#ifdef LINK_ADR_ENABLED
+    {
+        uint8_t dataRate = LMIC.datarate;
+        int8_t power = LMIC.adrTxPow;
+
+        // RX2 uses a fixed data rate, its SNR says nothing about the uplink's
+        linkAdr.update(dataRate, (event.txrxFlags & TXRX_DNW1) != 0,
+                       event.snr, ackRequested, acked);
+        if (linkAdr.adjust(dataRate, power))
+        {
+            LMIC_setDrTxpow(dataRate, power);
+            BINLOG(LINK_ADR, getSf(uplinkRps) + 6, 7 + regionPlan.fastestDataRate - dataRate, power, linkAdr.getMarginDb());
+        }
+        linkDataRate = dataRate;
+        linkTxPower = power;
+    }
+#endif
+
+    // any downlink proves the link, missed acks of confirmed uplinks count against it
+    if (event.txrxFlags & (TXRX_ACK | TXRX_DNW1 | TXRX_DNW2))
+    {
+        missedAcks = 0;
+        setLinkDown(false);
+    }
+    else if (event.txrxFlags & TXRX_NACK)
+    {
+        if (missedAcks < UINT8_MAX)
+        {
+            missedAcks++;
+        }
+        if (missedAcks >= BACKLOG_MISSED_ACKS)
+        {
+            setLinkDown(true);
+        }
+    }
+    drainBacklog();
+
+#ifdef DISPLAY_ENABLED
+    {
+        StatusSnapshot snapshot = {};
+        snapshot.kind = SNAPSHOT_TXCOMPLETE;
+#if LINK_STATS_PAGE_EVERY > 0
+        if (linkStats.getSnapshot().totalUplinks % LINK_STATS_PAGE_EVERY == 0)
+        {
+            snapshot.kind = SNAPSHOT_LINK_STATS;
+            snapshot.linkStats = &linkStats;
+        }
+#endif
+        snapshot.txCounter = event.seqnoUp - 1;
+        snapshot.rxCounter = rxFrameCounter;
+        snapshot.dataLen = event.dataLen;
+        snapshot.rssi = event.rssi;
+        snapshot.snr = event.snr;
+        snapshot.sf = getSf(uplinkRps) + 6;
+        snapshot.bandwidth = bwf[getBw(uplinkRps)];
+        snapshot.freq = uplinkFreq;
+#ifdef ADC_PIN
+        snapshot.batteryMv = analogRead(ADC_PIN) * 6600UL / 4095;
+#endif
+        displayHandler.show(snapshot);
+    }
+#endif
+
+    // RTC memory only, flash every SEQUENCE_COMMIT_INTERVAL frames
+    if (sessionStore.storeSequence(event.seqnoUp))
+    {
+        BINLOG(SEQUENCE_STORED, event.seqnoUp);
+    }
+#ifdef ACTIVATION_MODE_OTAA
+    // data rate, channels and RX parameters may have been changed by the network
+    if (sessionStore.saveSession(false))
+    {
+        BINLOG(SESSION_SAVED, LMIC.devaddr, sessionStore.getJoins());
+    }
+#endif
+
+#ifdef DEEP_SLEEP_ENABLED
+    // keep the status visible, LMIC keeps running until then
+#ifdef DISPLAY_ENABLED
+    if (displayHandler.isActive())
+    {
+        os_setTimedCallback(&sleepjob, os_getTime() + ms2osticks(DISPLAY_HOLD_TIME_MS), do_sleep);
+        return;
+    }
+#endif
+    os_setCallback(&sleepjob, do_sleep);
+#else
+    {
+        // without light sleep wall time equals awake time
+        unsigned long now = millis();
+        if (lastCycleStart != 0)
+        {
+            BINLOG(CYCLE_TIME, now - lastCycleStart, now - lastCycleStart - (sleptMs - lastCycleSleptMs));
+        }
+        lastCycleStart = now;
+        lastCycleSleptMs = sleptMs;
+    }
+
+#ifndef SAMPLE_INTERVAL
+    // Schedule next transmission, with SAMPLE_INTERVAL do_sample() sends
+    scheduleSend();
+#endif
+#endif
+}
+
+static void onLostTsync(const LoRaWANEvent &event)
+{
+    BINLOG(EV_LOST_TSYNC, event.timestamp);
+    DISPLAY_ERROR("LOST_TSYNC");
+}
+
+static void onReset(const LoRaWANEvent &event)
+{
+    BINLOG(EV_RESET, event.timestamp);
+    DISPLAY_ERROR("RESET");
+}
+
+static void onRxComplete(const LoRaWANEvent &event)
+{
+    // data received in ping slot
+    BINLOG(EV_RXCOMPLETE, event.timestamp);
+}
+
+static void onLinkDead(const LoRaWANEvent &event)
+{
+    BINLOG(EV_LINK_DEAD, event.timestamp);
+    setLinkDown(true);
+    DISPLAY_ERROR("LINK_DEAD");
+}
+
+static void onLinkAlive(const LoRaWANEvent &event)
+{
+    BINLOG(EV_LINK_ALIVE, event.timestamp);
+    missedAcks = 0;
+    setLinkDown(false);
+    DISPLAY_STATUS("LINK_ALIVE");
+}
+
+// Runs right before the RX windows open, keep it short: processEvents()
+// defers everything queued after it until the windows are closed.
+static void onTxStart(const LoRaWANEvent &event)
+{
+    binLog.beginWindow();
+    BINLOG(EV_TXSTART, event.timestamp);
+    if (!firstTxStarted)
+    {
+        // micros() counts from this boot or wake up
+        BINLOG(FIRST_TX, event.enqueuedUs / 1000, LoRaWANHandler::isWarmWake());
+        firstTxStarted = true;
+    }
+    DISPLAY_STATUS("TXSTART");
+    BINLOG(LINK_STATUS, (int)event.rssi, (int)event.snr, getSf(event.rps) + 6);
+    uplinkRps = event.rps;
+    uplinkFreq = event.freq;
+    {
+        // dataLen is the length of the whole frame being sent
+        uint32_t airtime = rpsAirtimeUs(event.rps, event.dataLen);
+        lastAirtimeUs = airtime;
+        uplinkAirtimeUs += airtime;
+        // the off-time LMIC starts for the band of this channel, none in US915 and AU915
+        uplinkScheduler.transmitted(clockSeconds(), airtime, regionOffTimeFactor(regionPlan, event.freq));
+#ifdef AIRTIME_BUDGET_MS
+        airtimeBudget.record(clockSeconds(), airtime);
+        transmitInterval = airtimeBudget.nextInterval(clockSeconds(), airtime, settingsStore.get().interval);
+        configureStreams();
+        BINLOG(AIRTIME, airtime / 1000, airtimeBudget.usedMs(clockSeconds()), transmitInterval);
+#endif
+    }
+}
+
+// LMIC dropped the frame, no EV_TXCOMPLETE follows. The telemetry waits
+// in the backlog, diagnostics and alarms go out with the next uplink.
+static void onTxCanceled(const LoRaWANEvent &event)
+{
+    BINLOG(EV_TXCANCELED, event.timestamp);
+    uint8_t streams = uplinkScheduler.getInFlight();
+    uplinkScheduler.canceled();
+    parkStreams(streams & ((1 << STREAM_TELEMETRY) | (1 << STREAM_BACKLOG)));
+#ifdef SAMPLE_INTERVAL
+    if (streams & (1 << STREAM_TELEMETRY))
+    {
+        // the readings live in the backlog now
+        sampleBuffer.commit();
+    }
+    else
+    {
+        sampleBuffer.release();
+    }
+#endif
+    drainBacklog();
+    DISPLAY_ERROR("TXCANCELED");
+
+    // the next cycle, as after EV_TXCOMPLETE
+#ifdef DEEP_SLEEP_ENABLED
+    os_setCallback(&sleepjob, do_sleep);
+#elif !defined(SAMPLE_INTERVAL)
+    scheduleSend();
+#endif
+}
+
+static void onJoinTxComplete(const LoRaWANEvent &event)
+{
+    BINLOG(EV_JOIN_TXCOMPLETE, event.timestamp);
+    DISPLAY_STATUS("NO JOIN ACCEPTED");
+}
+
+static void registerHandlers()
+{
+    eventTable[EV_SCAN_TIMEOUT].handler = onScanTimeout;
+    eventTable[EV_BEACON_FOUND].handler = onBeaconFound;
+    eventTable[EV_BEACON_MISSED].handler = onBeaconMissed;
+    eventTable[EV_BEACON_TRACKED].handler = onBeaconTracked;
+    eventTable[EV_JOINING].handler = onJoining;
+    eventTable[EV_JOINED].handler = onJoined;
+    eventTable[EV_JOIN_FAILED].handler = onJoinFailed;
+    eventTable[EV_REJOIN_FAILED].handler = onRejoinFailed;
+    eventTable[EV_TXCOMPLETE].handler = onTxComplete;
+    eventTable[EV_LOST_TSYNC].handler = onLostTsync;
+    eventTable[EV_RESET].handler = onReset;
+    eventTable[EV_RXCOMPLETE].handler = onRxComplete;
+    eventTable[EV_LINK_DEAD].handler = onLinkDead;
+    eventTable[EV_LINK_ALIVE].handler = onLinkAlive;
+    eventTable[EV_TXSTART].handler = onTxStart;
+    eventTable[EV_TXCANCELED].handler = onTxCanceled;
+    eventTable[EV_RXSTART].handler = onRxStart;
+    eventTable[EV_JOIN_TXCOMPLETE].handler = onJoinTxComplete;
+}
+
+static void handleEvent(const LoRaWANEvent &event)
+{
+    if ((unsigned)event.ev >= LORAWAN_EVENT_COUNT ||
+        (eventTable[event.ev].handler == NULL && eventTable[event.ev].hook == NULL))
+    {
+        BINLOG(EV_UNKNOWN, event.timestamp, (unsigned)event.ev);
+        return;
+    }
+
+    EventTableEntry &entry = eventTable[event.ev];
+    uint32_t start = ESP.getCycleCount();
+
+    if (entry.handler != NULL)
+    {
+        entry.handler(event);
+    }
+    if (entry.hook != NULL)
+    {
+        entry.hook(event);
+    }
+
+    uint32_t cycles = ESP.getCycleCount() - start;
+    entry.profile.calls++;
+    entry.profile.lastCycles = cycles;
+    entry.profile.sumCycles += cycles;
+    if (cycles > entry.profile.maxCycles)
+    {
+        entry.profile.maxCycles = cycles;
+    }
+}
+
+void LoRaWANHandler::setup()
+{
+#ifdef VCC_ENABLE
+    // For Pinoccio Scout boards
+    pinMode(VCC_ENABLE, OUTPUT);
+    digitalWrite(VCC_ENABLE, HIGH);
+    delay(1000);
+#endif
+
+#ifdef AIRTIME_BUDGET_MS
+    airtimeBudget.begin(AIRTIME_BUDGET_MS);
+#endif
+
+    registerHandlers();
+    confirmedUplink.begin(CONFIRMED_EVERY);
+    linkStats.begin();
+
+#ifdef BACKLOG_POLICY_NEWEST_FIRST
+    backlog.begin(BACKLOG_NEWEST_FIRST);
+#else
+    backlog.begin(BACKLOG_OLDEST_FIRST);
+#endif
+
+    // LMIC init
+    os_init();
+#ifndef LMIC_USE_INTERRUPTS
+    // LMIC only reads the lines, the edge times show its polling delay
+    attachInterrupt(digitalPinToInterrupt(LMIC_DIO0), onDio0Edge, RISING);
+    attachInterrupt(digitalPinToInterrupt(LMIC_DIO1), onDio1Edge, RISING);
+#endif
+    // Reset the MAC state. Session and pending data transfers will be discarded.
+    LMIC.rssi = 0;
+    LMIC_reset();
+
+    // build flags, unless changed by a downlink
+    const DeviceSettings &settings = settingsStore.restore();
+    if (!isWarmWake())
+    {
+        transmitInterval = settings.interval;
+    }
+    configureStreams();
+
+#ifdef LINK_ADR_ENABLED
+    // the device side tracker adjusts data rate and power, LMIC resets with ADR on
+    LMIC_setAdrMode(0);
+#else
+    // LMIC resets with ADR on, it stays off unless ADR_ENABLED or a
+    // downlink turns it on and the network server adjusts data rate and power
+    LMIC_setAdrMode(settings.adr);
+#endif
+
+#ifdef LINK_ADR_ENABLED
+    linkAdr.begin(regionPlan.slowestDataRate, regionPlan.fastestDataRate, 2, 14);
+#endif
+
+#ifdef ACTIVATION_MODE_OTAA
+    // continue the last session instead of joining again
+    SessionSource source = sessionStore.restoreSession();
+    if (source != SESSION_NONE)
+    {
+        LMIC_setLinkCheckMode(0);
+        BINLOG(SESSION_RESTORED, LMIC.devaddr, LMIC.seqnoUp, source == SESSION_FLASH);
+    }
+#endif
+
+#ifdef ACTIVATION_MODE_ABP
+    LMIC_setSession(0x13, DEVADDR, NETWORK_SESSION_KEY, APP_SESSION_KEY);
+
+    // TTN channels and RX2 data rate, e.g. SF9 in EU868
+    applyRegionPlan();
+
+    // Disable link check validation
+    LMIC_setLinkCheckMode(0);
+
+    // Set data rate and transmit power for uplink
+#ifdef LINK_ADR_ENABLED
+    if (!isWarmWake())
+    {
+        linkDataRate = spreadingFactorDataRate(settings.spreadingFactor);
+        linkTxPower = settings.txPower;
+    }
+    // continue with the setting found before deep sleep
+    LMIC_setDrTxpow(linkDataRate, linkTxPower);
+#else
+    LMIC_setDrTxpow(spreadingFactorDataRate(settings.spreadingFactor), settings.txPower);
+#endif
+#endif
+
+#ifdef DISPLAY_ENABLED
+    if (!settings.display)
+    {
+        displayHandler.sleep();
+    }
+#endif
+}
+
+void LoRaWANHandler::runOnce()
+{
+    os_runloop_once();
+    processEvents();
+#ifdef DISPLAY_ENABLED
+    // the event handlers only invalidate the screen
+    displayHandler.update();
+#endif
+
+    // serial output only while no TX/RX is running
+    if (!(LMIC.opmode & OP_TXRXPEND))
+    {
+        binLog.drain();
+    }
+
+    idle();
+}
+
+// Light sleep until the next LMIC job is due or the display may redraw.
+// Never while a TX/RX is pending, the RX windows are timed by polling the
+// DIO lines.
+void LoRaWANHandler::idle()
+{
+#ifdef LIGHT_SLEEP_ENABLED
+    if ((LMIC.opmode & OP_TXRXPEND) || !eventQueue.empty() || !binLog.empty())
+    {
+        return;
+    }
+#ifdef DISPLAY_ENABLED
+    if (!renderPipeline.idle())
+    {
+        return;
+    }
+#endif
+
+    // the deadline is now if a job is runnable
+    bit_t deadlineValid = 0;
+    ostime_t deadline = os_getNextDeadline(&deadlineValid);
+    ostime_t delta = deadlineValid ? deadline - os_getTime() : ms2osticks(LIGHT_SLEEP_MAX_MS);
+#ifdef DISPLAY_ENABLED
+    // or until the next redraw is allowed
+    uint32_t redrawMs = displayHandler.timeUntilNextUpdate();
+    if (redrawMs != RENDER_NO_DEADLINE && ms2osticks(redrawMs) < delta)
+    {
+        delta = ms2osticks(redrawMs);
+    }
+#endif
+
+    if (delta < ms2osticks(LIGHT_SLEEP_MIN_MS))
+    {
+        return;
+    }
+    delta -= ms2osticks(LIGHT_SLEEP_GUARD_MS);
+
+#ifdef SERIAL_ENABLED
+    // the UART stops in light sleep
+    Serial.flush();
+#endif
+
+    esp_sleep_enable_timer_wakeup(osticks2us(delta));
+    gpio_wakeup_enable((gpio_num_t)LMIC_DIO0, GPIO_INTR_HIGH_LEVEL);
+    gpio_wakeup_enable((gpio_num_t)LMIC_DIO1, GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+
+    // micros() and with it os_getTime() keep counting through light sleep
+    unsigned long start = millis();
+    esp_light_sleep_start();
+    sleptMs += millis() - start;
+#endif
+}
+
+void LoRaWANHandler::processEvents()
+{
+    LoRaWANEvent event;
+
+    while (!eventQueue.empty())
+    {
+        // keep serial output and flash writes away from the RX windows
+        if (os_queryTimeCriticalJobs(ms2osticks(EVENT_GUARD_TIME_MS)))
+        {
+            return;
+        }
+
+        if (!eventQueue.pop(event))
+        {
+            return;
+        }
+
+        uint32_t latency = micros() - event.enqueuedUs;
+        eventStatistics.lastLatencyUs = latency;
+        eventStatistics.sumLatencyUs += latency;
+        if (latency > eventStatistics.maxLatencyUs)
+        {
+            eventStatistics.maxLatencyUs = latency;
+        }
+        eventStatistics.processed++;
+
+        handleEvent(event);
+    }
+}
+
+bool LoRaWANHandler::isWarmWake()
+{
+#ifdef DEEP_SLEEP_ENABLED
+    return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+#else
+    return false;
+#endif
+}
+
+const LoRaWANEventStatistics &LoRaWANHandler::getEventStatistics()
+{
+    return eventStatistics;
+}
+
+const RxTiming &LoRaWANHandler::getRxTiming()
+{
+    return rxTiming;
+}
+
+bool LoRaWANHandler::setEventHook(ev_t ev, LoRaWANEventHandler hook)
+{
+    if ((unsigned)ev >= LORAWAN_EVENT_COUNT)
+    {
+        return false;
+    }
+    eventTable[ev].hook = hook;
+    return true;
+}
+
+const LoRaWANHandlerProfile &LoRaWANHandler::getHandlerProfile(ev_t ev)
+{
+    static const LoRaWANHandlerProfile none = {};
+    return (unsigned)ev < LORAWAN_EVENT_COUNT ? eventTable[ev].profile : none;
+}
+
+void LoRaWANHandler::printHandlerProfile()
+{
+    SERIAL_PRINTLN("event  calls  max cycles  mean cycles");
+    for (uint8_t ev = 0; ev < LORAWAN_EVENT_COUNT; ev++)
+    {
+        const LoRaWANHandlerProfile &profile = eventTable[ev].profile;
+        if (profile.calls > 0)
+        {
+            SERIAL_PRINTF("%5u %6u %11u %12u\n", ev, profile.calls, profile.maxCycles,
+                          (uint32_t)(profile.sumCycles / profile.calls));
+        }
+    }
+}
+
+void LoRaWANHandler::printLinkStats()
+{
+    const LinkStatsSnapshot &link = linkStats.getSnapshot();
+    SERIAL_PRINTF("uplinks %u of %u, rx1 %u, rx2 %u, acked %u of %u (%u %%), airtime %u ms mean\n",
+                  link.uplinks, link.totalUplinks, link.rx1, link.rx2, link.acked, link.ackRequested,
+                  LinkStats::ackRate(link), LinkStats::meanAirtimeUs(link) / 1000);
+    SERIAL_PRINTF("rssi %d dBm mean, snr %d dB mean\n", LinkStats::meanRssi(link), LinkStats::meanSnr(link));
+
+    SERIAL_PRINTLN("  dBm  rssi    dB  snr    sf  uplinks");
+    for (uint8_t bin = 0; bin < LINK_STATS_RSSI_BINS; bin++)
+    {
+        SERIAL_PRINTF("%5d %5u %5d %4u", LinkStats::rssiBinFloor(bin), link.rssiBins[bin],
+                      LinkStats::snrBinFloor(bin), link.snrBins[bin]);
+        if (bin < LINK_STATS_SF_BINS)
+        {
+            SERIAL_PRINTF(" %5u %8u", LINK_STATS_SF_MIN + bin, link.spreadingFactors[bin]);
+        }
+        SERIAL_PRINTLN("");
+    }
+}
+
+bool LoRaWANHandler::processDownlink(const uint8_t *data, uint8_t length)
+{
+    DeviceSettings settings = settingsStore.get();
+    DownlinkResult result = downlinkApply(data, length, settings);
+
+    BINLOG(DOWNLINK, result.status, result.changed, result.offset);
+    if (result.status != DOWNLINK_OK)
+    {
+        downlinksRejected++;
+        return false;
+    }
+    downlinksAccepted++;
+
+    if (result.changed & DOWNLINK_CHANGED_SETTINGS)
+    {
+        settingsStore.save(settings);
+        applySettings(settings, result.changed);
+    }
+    if (result.changed & DOWNLINK_CHANGED_DIAGNOSTICS)
+    {
+        queueDiagnostics();
+    }
+    return true;
+}
+
+bool LoRaWANHandler::submit(uint8_t stream, const uint8_t *data, uint8_t length)
+{
+    if (stream == STREAM_TELEMETRY)
+    {
+        return submitTelemetry(data, length, clockSeconds());
+    }
+    return uplinkScheduler.submit(stream, data, length, clockSeconds());
+}
+
+bool LoRaWANHandler::sendAlarm(const uint8_t *data, uint8_t length)
+{
+    if (!submit(STREAM_ALARM, data, length))
+    {
+        return false;
+    }
+    // replaces the scheduled send job, EV_TXCOMPLETE schedules the next one
+    os_setCallback(&sendjob, do_send);
+    return true;
+}
+
+const UplinkScheduler &LoRaWANHandler::getUplinkScheduler()
+{
+    return uplinkScheduler;
+}
+
+const ConfirmedUplink &LoRaWANHandler::getConfirmedUplink()
+{
+    return confirmedUplink;
+}
+
+const LinkStats &LoRaWANHandler::getLinkStats()
+{
+    return linkStats;
+}
+
+bool LoRaWANHandler::isLinkUp()
+{
+    return !linkDown;
+}
+
+void LoRaWANHandler::start()
+{
+#ifdef ACTIVATION_MODE_ABP
+    LMIC.seqnoUp = sessionStore.restoreSequence();
+    SERIAL_PRINTF(SEQUENCE_KEY "=%u\n", LMIC.seqnoUp);
+#endif
+
+#ifdef SAMPLE_INTERVAL
+    do_sample(&samplejob);
+#else
+    do_send(&sendjob);
+#endif
+}
+
+// Readings per uplink for the current data rate, as many as fit into the
+// maximum payload and the batch setting, preferring the least airtime per reading.
+uint8_t LoRaWANHandler::batchSize()
+{
+    uint8_t capacity = payloadBatchCapacity(uplinkPayloadSize());
+    if (capacity > settingsStore.get().batchMax)
+    {
+        capacity = settingsStore.get().batchMax;
+    }
+
+    rps_t rps = updr2rps(LMIC.datarate);
+    uint8_t best = 1;
+    uint32_t bestCost = UINT32_MAX;
+
+    for (uint8_t count = 1; count <= capacity; count++)
+    {
+        uint32_t cost = rpsAirtimeUs(rps, LORAWAN_FRAME_OVERHEAD + payloadBatchSize(count)) / count;
+        if (cost <= bestCost)
+        {
+            best = count;
+            bestCost = cost;
+        }
+    }
+    return best;
 }
 
 void LoRaWANHandler::printPinout()
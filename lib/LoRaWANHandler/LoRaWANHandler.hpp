@@ -1,25 +1,92 @@
 #ifndef __LORAWAN_HANDLER_H__
 #define __LORAWAN_HANDLER_H__
 
-#include <SPI.h>
-#include <Wire.h>
-#include <SSD1306Wire.h>
 #include <lmic.h>
+#include <RxTiming.hpp>
+#include <UplinkScheduler.hpp>
+#include <Backlog.hpp>
+#include <ConfirmedUplink.hpp>
+#include <LinkStats.hpp>
+#include "LoRaWANEvent.hpp"
 
-#define PREFERENCE_NAME "lmic"
-#define SEQUENCE_KEY "sequence"
+#define TELEMETRY_PORT 1
+#ifndef ALARM_PORT
+#define ALARM_PORT 12
+#endif
+// telemetry that waited in the backlog, same format as TELEMETRY_PORT
+#ifndef BACKLOG_PORT
+#define BACKLOG_PORT 13
+#endif
+
+// seconds a diagnostics report waits for a telemetry uplink to share
+#ifndef DIAGNOSTICS_DEADLINE
+#define DIAGNOSTICS_DEADLINE 600
+#endif
+
+// seconds between diagnostics reports without a request, 0 = only on request
+#ifndef DIAGNOSTICS_INTERVAL
+#define DIAGNOSTICS_INTERVAL 0
+#endif
+
+// every n-th uplink shows the link statistics page instead of its own, 0 = never
+#ifndef LINK_STATS_PAGE_EVERY
+#define LINK_STATS_PAGE_EVERY 4
+#endif
+
+// consecutive unacknowledged confirmed uplinks that mark the link as down
+#ifndef BACKLOG_MISSED_ACKS
+#define BACKLOG_MISSED_ACKS 3
+#endif
+
+// while the link is down every n-th telemetry payload is still sent, to see it come back
+#ifndef BACKLOG_PROBE_INTERVAL
+#define BACKLOG_PROBE_INTERVAL 4
+#endif
+
+enum UplinkStream : uint8_t
+{
+  STREAM_TELEMETRY,
+  STREAM_DIAGNOSTICS,
+  STREAM_ALARM,
+  STREAM_BACKLOG
+};
 
 class LoRaWANHandler
 {
 public:
   void setup();
+  // woken up from deep sleep by the timer, the session is in RTC memory
+  static bool isWarmWake();
   void runOnce();
+  void processEvents();
+  void idle();
+  const LoRaWANEventStatistics &getEventStatistics();
+  const RxTiming &getRxTiming();
+  // called after the built-in handler of ev, from processEvents()
+  bool setEventHook(ev_t ev, LoRaWANEventHandler hook);
+  const LoRaWANHandlerProfile &getHandlerProfile(ev_t ev);
+  void printHandlerProfile();
   void start();
+  // commands received on DOWNLINK_PORT, false if the frame was rejected
+  bool processDownlink(const uint8_t *data, uint8_t length);
+  // payload for the next uplink of the stream
+  bool submit(uint8_t stream, const uint8_t *data, uint8_t length);
+  // sent as soon as the duty cycle allows, with the other pending payloads
+  bool sendAlarm(const uint8_t *data, uint8_t length);
+  const UplinkScheduler &getUplinkScheduler();
+  const ConfirmedUplink &getConfirmedUplink();
+  // RSSI, SNR, spreading factors, acks, downlinks and airtime of the recent uplinks
+  const LinkStats &getLinkStats();
+  void printLinkStats();
+  // false after EV_LINK_DEAD or BACKLOG_MISSED_ACKS missed acks, until a downlink arrives
+  bool isLinkUp();
   void printPinout();
+  uint8_t batchSize();
 };
 
 extern LoRaWANHandler loRaWANHandler;
 
+extern void lora_sample();
 extern void lora_send(unsigned long txFrameCounter);
 extern void lora_receive(unsigned long rxFrameCounter);
 
@@ -0,0 +1,228 @@
+#include <string.h>
+#include "Payload.hpp"
+
+uint8_t payloadEncodeBattery(uint16_t batteryMv)
+{
+    if (batteryMv == 0)
+    {
+        return PAYLOAD_BATTERY_UNKNOWN;
+    }
+    if (batteryMv <= PAYLOAD_BATTERY_OFFSET_MV)
+    {
+        return 0;
+    }
+
+    uint32_t value = (batteryMv - PAYLOAD_BATTERY_OFFSET_MV + PAYLOAD_BATTERY_STEP_MV / 2) / PAYLOAD_BATTERY_STEP_MV;
+    return value >= PAYLOAD_BATTERY_UNKNOWN ? PAYLOAD_BATTERY_UNKNOWN - 1 : value;
+}
+
+int8_t payloadEncodeRssi(int16_t rssi)
+{
+    if (rssi < INT8_MIN)
+    {
+        return INT8_MIN;
+    }
+    if (rssi > INT8_MAX)
+    {
+        return INT8_MAX;
+    }
+    return rssi;
+}
+
+size_t payloadEncodeReading(uint8_t *buffer, size_t size, const Reading &reading)
+{
+    if (size < PAYLOAD_READING_SIZE)
+    {
+        return 0;
+    }
+
+    buffer[0] = PAYLOAD_VERSION_READING;
+    buffer[1] = (reading.counter >> 8) & 0xff;
+    buffer[2] = reading.counter & 0xff;
+    buffer[3] = payloadEncodeBattery(reading.batteryMv);
+    buffer[4] = (uint8_t)payloadEncodeRssi(reading.rssi);
+
+    return PAYLOAD_READING_SIZE;
+}
+
+size_t payloadBatchSize(uint8_t count)
+{
+    return PAYLOAD_BATCH_HEADER_SIZE + count * PAYLOAD_BATCH_READING_SIZE;
+}
+
+uint8_t payloadBatchCapacity(size_t size)
+{
+    if (size < payloadBatchSize(1))
+    {
+        return 0;
+    }
+
+    size_t capacity = (size - PAYLOAD_BATCH_HEADER_SIZE) / PAYLOAD_BATCH_READING_SIZE;
+    return capacity > UINT8_MAX ? UINT8_MAX : capacity;
+}
+
+size_t payloadEncodeBatch(uint8_t *buffer, size_t size, uint32_t counter,
+                          uint16_t interval, const Reading *readings, uint8_t count)
+{
+    uint8_t capacity = payloadBatchCapacity(size);
+    if (count > capacity)
+    {
+        count = capacity;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    buffer[0] = PAYLOAD_VERSION_BATCH;
+    buffer[1] = count;
+    buffer[2] = (counter >> 8) & 0xff;
+    buffer[3] = counter & 0xff;
+    buffer[4] = (interval >> 8) & 0xff;
+    buffer[5] = interval & 0xff;
+
+    uint8_t *p = buffer + PAYLOAD_BATCH_HEADER_SIZE;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        *p++ = payloadEncodeBattery(readings[i].batteryMv);
+        *p++ = (uint8_t)payloadEncodeRssi(readings[i].rssi);
+    }
+
+    return payloadBatchSize(count);
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static uint8_t varintSize(uint32_t value)
+{
+    uint8_t n = 1;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static uint8_t *writeVarint(uint8_t *p, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        *p++ = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    *p++ = value;
+    return p;
+}
+
+// size of a series, 0 if it does not fit
+static size_t encodeSeries(uint8_t *buffer, size_t size, const int16_t *values,
+                           uint8_t count, bool zigzagFirst)
+{
+    uint32_t first = zigzagFirst ? zigzag(values[0]) : (uint32_t)values[0];
+    uint32_t deltas[UINT8_MAX];
+    size_t varintLength = 0;
+    uint8_t width = 0;
+
+    for (uint8_t i = 1; i < count; i++)
+    {
+        deltas[i - 1] = zigzag(values[i] - values[i - 1]);
+        varintLength += varintSize(deltas[i - 1]);
+        while (width < 16 && (deltas[i - 1] >> width) != 0)
+        {
+            width++;
+        }
+    }
+
+    size_t packedLength = ((count - 1) * width + 7) / 8;
+    bool packed = packedLength <= varintLength;
+    size_t length = varintSize(first) + 1 + (packed ? packedLength : varintLength);
+    if (length > size)
+    {
+        return 0;
+    }
+
+    uint8_t *p = writeVarint(buffer, first);
+    if (packed)
+    {
+        *p++ = width;
+        memset(p, 0, packedLength);
+        uint32_t bit = 0;
+        for (uint8_t i = 0; i < count - 1; i++)
+        {
+            for (int8_t b = width - 1; b >= 0; b--, bit++)
+            {
+                if (deltas[i] & (1UL << b))
+                {
+                    p[bit / 8] |= 0x80 >> (bit % 8);
+                }
+            }
+        }
+    }
+    else
+    {
+        *p++ = PAYLOAD_DELTA_VARINT;
+        for (uint8_t i = 0; i < count - 1; i++)
+        {
+            p = writeVarint(p, deltas[i]);
+        }
+    }
+
+    return length;
+}
+
+size_t payloadEncodeDeltaBatch(uint8_t *buffer, size_t size, uint32_t counter,
+                               uint16_t interval, const Reading *readings, uint8_t count)
+{
+    if (count == 0 || size < PAYLOAD_BATCH_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    int16_t values[UINT8_MAX];
+
+    buffer[0] = PAYLOAD_VERSION_DELTA_BATCH;
+    buffer[1] = count;
+    buffer[2] = (counter >> 8) & 0xff;
+    buffer[3] = counter & 0xff;
+    buffer[4] = (interval >> 8) & 0xff;
+    buffer[5] = interval & 0xff;
+    size_t length = PAYLOAD_BATCH_HEADER_SIZE;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        values[i] = payloadEncodeBattery(readings[i].batteryMv);
+    }
+    size_t n = encodeSeries(buffer + length, size - length, values, count, false);
+    if (n == 0)
+    {
+        return 0;
+    }
+    length += n;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        values[i] = payloadEncodeRssi(readings[i].rssi);
+    }
+    n = encodeSeries(buffer + length, size - length, values, count, true);
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    return length + n;
+}
+
+size_t payloadEncodeCompactBatch(uint8_t *buffer, size_t size, uint32_t counter,
+                                 uint16_t interval, const Reading *readings, uint8_t count)
+{
+    size_t length = payloadEncodeDeltaBatch(buffer, size, counter, interval, readings, count);
+    if (length == 0 || length > payloadBatchSize(count))
+    {
+        length = payloadEncodeBatch(buffer, size, counter, interval, readings, count);
+    }
+    return length;
+}
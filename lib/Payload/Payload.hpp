@@ -0,0 +1,70 @@
+#ifndef __PAYLOAD_H__
+#define __PAYLOAD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary uplink payload, decoded by TTNv3/payload_formatter.js
+ *
+ * version 1 (5 bytes):
+ *   0    version
+ *   1-2  frame counter, lower 16 bits, big endian
+ *   3    battery, (mV - 2000) / 20, 0xff = not measured
+ *   4    rssi of the last downlink, signed dBm
+ *
+ * version 2, batch (6 + 2 * count bytes):
+ *   0    version
+ *   1    number of readings
+ *   2-3  frame counter, lower 16 bits, big endian
+ *   4-5  seconds between two readings, big endian
+ *   per reading, oldest first:
+ *   +0   battery, as in version 1
+ *   +1   rssi, as in version 1
+ *
+ * version 3, delta compressed batch:
+ *   0-5  header as in version 2
+ *   battery series, then rssi series, each:
+ *        first value, varint (rssi zigzag encoded)
+ *        mode: 0xff = deltas follow as zigzag varints,
+ *              0..16 = deltas follow zigzag encoded and bit packed
+ *              with this many bits each, msb first, padded to a byte
+ *        count - 1 deltas to the previous value
+ */
+
+#define PAYLOAD_VERSION_READING 1
+#define PAYLOAD_READING_SIZE 5
+
+#define PAYLOAD_VERSION_BATCH 2
+#define PAYLOAD_BATCH_HEADER_SIZE 6
+#define PAYLOAD_BATCH_READING_SIZE 2
+
+#define PAYLOAD_VERSION_DELTA_BATCH 3
+#define PAYLOAD_DELTA_VARINT 0xff
+
+#define PAYLOAD_BATTERY_OFFSET_MV 2000
+#define PAYLOAD_BATTERY_STEP_MV 20
+#define PAYLOAD_BATTERY_UNKNOWN 0xff
+
+struct Reading
+{
+  uint32_t counter;
+  uint16_t batteryMv; // 0 = not measured
+  int16_t rssi;
+};
+
+extern uint8_t payloadEncodeBattery(uint16_t batteryMv);
+extern int8_t payloadEncodeRssi(int16_t rssi);
+extern size_t payloadEncodeReading(uint8_t *buffer, size_t size, const Reading &reading);
+
+extern size_t payloadBatchSize(uint8_t count);
+extern uint8_t payloadBatchCapacity(size_t size);
+extern size_t payloadEncodeBatch(uint8_t *buffer, size_t size, uint32_t counter,
+                                 uint16_t interval, const Reading *readings, uint8_t count);
+extern size_t payloadEncodeDeltaBatch(uint8_t *buffer, size_t size, uint32_t counter,
+                                      uint16_t interval, const Reading *readings, uint8_t count);
+// version 2 or 3, whichever is shorter
+extern size_t payloadEncodeCompactBatch(uint8_t *buffer, size_t size, uint32_t counter,
+                                        uint16_t interval, const Reading *readings, uint8_t count);
+
+#endif
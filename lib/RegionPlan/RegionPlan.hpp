@@ -0,0 +1,227 @@
+#ifndef __REGION_PLAN_H__
+#define __REGION_PLAN_H__
+
+#include <stdint.h>
+
+#define REGION_MAX_CHANNELS 16
+#define REGION_DATA_RATES 8
+#define REGION_MAX_PAYLOAD 242
+#define REGION_NO_SUB_BAND 0xff
+#define REGION_SUB_BAND_CHANNELS 8 // 125 kHz channels per sub-band
+#define REGION_CHANNEL_SPACING 200000 // Hz, fixed 125 kHz channels
+#define REGION_WIDE_CHANNEL_SPACING 1600000 // Hz, fixed 500 kHz channels
+
+// LMIC EU868 bands, 0.1 % and 1 % duty cycle
+#define REGION_BAND_MILLI 0
+#define REGION_BAND_CENTI 1
+#define REGION_BANDS 2
+
+struct RegionChannel
+{
+  uint32_t frequency; // Hz
+  uint8_t minDataRate;
+  uint8_t maxDataRate;
+  uint8_t band; // LMIC band, EU868 only
+};
+
+/*
+ * Channels, data rates and RX2 of a region as The Things Network uses
+ * them. Data rates are the region's LoRaWAN DR numbers, which are also
+ * LMIC's. Regions with fixed channels (US915, AU915) select a sub-band
+ * of eight 125 kHz channels and one 500 kHz channel instead.
+ */
+struct RegionPlan
+{
+  uint32_t minFrequency; // Hz, band edges
+  uint32_t maxFrequency;
+  uint8_t channelCount;
+  RegionChannel channels[REGION_MAX_CHANNELS];
+  uint8_t subBand; // 0 based, REGION_NO_SUB_BAND if channels are listed
+  // fixed channel grid, 125 kHz channel 0 and 500 kHz channel 64, 0 if
+  // channels are listed
+  uint32_t firstChannelFrequency; // Hz
+  uint32_t firstWideChannelFrequency; // Hz
+  uint8_t slowestDataRate; // 125 kHz, SF12 or SF10
+  uint8_t fastestDataRate; // 125 kHz, SF7
+  uint8_t rx2DataRate;
+  uint32_t rx2Frequency; // Hz
+  uint16_t dwellTimeMs; // uplink dwell time limit, 0 = none
+  // maximum application payload per uplink data rate within the dwell
+  // time, 0 if none
+  uint8_t maxPayload[REGION_DATA_RATES];
+  // off-time per airtime after an uplink in a band, 100 = 1 % duty cycle,
+  // 0 = none
+  uint16_t offTimeFactor[REGION_BANDS];
+};
+
+constexpr RegionPlan EU868_PLAN = {
+    863000000, 870000000,
+    9,
+    {{868100000, 0, 5, REGION_BAND_CENTI},
+     {868300000, 0, 6, REGION_BAND_CENTI}, // SF7 at 250 kHz as well
+     {868500000, 0, 5, REGION_BAND_CENTI},
+     {867100000, 0, 5, REGION_BAND_CENTI},
+     {867300000, 0, 5, REGION_BAND_CENTI},
+     {867500000, 0, 5, REGION_BAND_CENTI},
+     {867700000, 0, 5, REGION_BAND_CENTI},
+     {867900000, 0, 5, REGION_BAND_CENTI},
+     {868800000, 7, 7, REGION_BAND_MILLI}}, // FSK
+    REGION_NO_SUB_BAND,
+    0, 0,
+    0, 5,
+    3, 869525000, // SF9
+    0,
+    {51, 51, 51, 115, 222, 222, 222, 222}, // repeater compatible
+    {1000, 100}};
+
+// channels 8 to 15 and 65
+constexpr RegionPlan US915_PLAN = {
+    902000000, 928000000,
+    0,
+    {},
+    1,
+    902300000, 903000000,
+    0, 3,
+    8, 923300000, // SF12 at 500 kHz
+    400,
+    {11, 53, 125, 242, 242, 0, 0, 0},
+    {0, 0}};
+
+// channels 8 to 15 and 65
+constexpr RegionPlan AU915_PLAN = {
+    915000000, 928000000,
+    0,
+    {},
+    1,
+    915200000, 915900000,
+    0, 5,
+    8, 923300000, // SF12 at 500 kHz
+    0,
+    {51, 51, 51, 115, 242, 242, 242, 0},
+    {0, 0}};
+
+// with the 400 ms dwell time LMIC assumes until a TxParamSetupReq lifts
+// it, SF11 and SF12 do not fit
+constexpr RegionPlan AS923_PLAN = {
+    915000000, 928000000,
+    8,
+    {{923200000, 0, 5, 0},
+     {923400000, 0, 5, 0},
+     {922200000, 0, 5, 0},
+     {922400000, 0, 5, 0},
+     {922600000, 0, 5, 0},
+     {922800000, 0, 5, 0},
+     {923000000, 0, 5, 0},
+     {922000000, 0, 5, 0}},
+    REGION_NO_SUB_BAND,
+    0, 0,
+    2, 5,
+    2, 923200000, // SF10
+    400,
+    {0, 0, 11, 53, 125, 242, 242, 242},
+    {100, 100}};
+
+// Checked at compile time, C++11 constexpr functions are a single return
+
+constexpr bool regionFrequencyUnique(const RegionPlan &plan, uint8_t channel, uint8_t other)
+{
+  return other >= plan.channelCount ||
+         (plan.channels[other].frequency != plan.channels[channel].frequency &&
+          regionFrequencyUnique(plan, channel, other + 1));
+}
+
+constexpr bool regionChannelsValid(const RegionPlan &plan, uint8_t channel)
+{
+  return channel >= plan.channelCount ||
+         (plan.channels[channel].frequency >= plan.minFrequency &&
+          plan.channels[channel].frequency <= plan.maxFrequency &&
+          plan.channels[channel].minDataRate <= plan.channels[channel].maxDataRate &&
+          plan.channels[channel].maxDataRate < REGION_DATA_RATES &&
+          plan.channels[channel].band < REGION_BANDS &&
+          plan.maxPayload[plan.channels[channel].maxDataRate] > 0 &&
+          regionFrequencyUnique(plan, channel, channel + 1) &&
+          regionChannelsValid(plan, channel + 1));
+}
+
+// 125 kHz channel of a fixed channel grid, 0 to 63
+constexpr uint32_t regionChannelFrequency(const RegionPlan &plan, uint8_t channel)
+{
+  return plan.firstChannelFrequency + channel * (uint32_t)REGION_CHANNEL_SPACING;
+}
+
+// the 500 kHz channel of the sub-band, LoRaWAN channel 64 + sub-band
+constexpr uint32_t regionWideChannelFrequency(const RegionPlan &plan)
+{
+  return plan.firstWideChannelFrequency + plan.subBand * (uint32_t)REGION_WIDE_CHANNEL_SPACING;
+}
+
+// the 125 kHz channels LMIC_selectSubBand() enables, one bit per channel
+constexpr uint64_t regionSubBandMask(const RegionPlan &plan)
+{
+  return plan.subBand == REGION_NO_SUB_BAND ? 0 : 0xffULL << (REGION_SUB_BAND_CHANNELS * plan.subBand);
+}
+
+// all channels of the sub-band within the band edges
+constexpr bool regionSubBandValid(const RegionPlan &plan)
+{
+  return plan.subBand == REGION_NO_SUB_BAND
+             ? plan.firstChannelFrequency == 0 && plan.firstWideChannelFrequency == 0
+             : plan.subBand < 8 &&
+                   regionChannelFrequency(plan, REGION_SUB_BAND_CHANNELS * plan.subBand) >= plan.minFrequency &&
+                   regionChannelFrequency(plan, REGION_SUB_BAND_CHANNELS * plan.subBand + 7) <= plan.maxFrequency &&
+                   regionWideChannelFrequency(plan) >= plan.minFrequency &&
+                   regionWideChannelFrequency(plan) <= plan.maxFrequency;
+}
+
+// payloads of the 125 kHz data rates, slowest to fastest, never shrink
+constexpr bool regionPayloadsValid(const RegionPlan &plan, uint8_t dataRate)
+{
+  return dataRate > plan.fastestDataRate ||
+         (plan.maxPayload[dataRate] > 0 && plan.maxPayload[dataRate] <= REGION_MAX_PAYLOAD &&
+          (dataRate == plan.slowestDataRate || plan.maxPayload[dataRate] >= plan.maxPayload[dataRate - 1]) &&
+          regionPayloadsValid(plan, dataRate + 1));
+}
+
+constexpr bool regionPlanValid(const RegionPlan &plan)
+{
+  return plan.minFrequency < plan.maxFrequency &&
+         plan.channelCount <= REGION_MAX_CHANNELS &&
+         // listed channels or a sub-band, not both
+         (plan.channelCount == 0) == (plan.subBand != REGION_NO_SUB_BAND) &&
+         regionSubBandValid(plan) &&
+         plan.slowestDataRate <= plan.fastestDataRate &&
+         plan.fastestDataRate < REGION_DATA_RATES &&
+         plan.rx2DataRate < 16 &&
+         plan.rx2Frequency >= plan.minFrequency && plan.rx2Frequency <= plan.maxFrequency &&
+         regionChannelsValid(plan, 0) &&
+         regionPayloadsValid(plan, plan.slowestDataRate);
+}
+
+// off-time factor after an uplink on frequency, that of the stricter band
+// for a channel the plan does not list
+constexpr uint16_t regionOffTimeFactor(const RegionPlan &plan, uint32_t frequency, uint8_t channel = 0)
+{
+  return channel >= plan.channelCount
+             ? (plan.offTimeFactor[0] > plan.offTimeFactor[1] ? plan.offTimeFactor[0] : plan.offTimeFactor[1])
+         : plan.channels[channel].frequency == frequency
+             ? plan.offTimeFactor[plan.channels[channel].band]
+             : regionOffTimeFactor(plan, frequency, channel + 1);
+}
+
+static_assert(regionPlanValid(EU868_PLAN), "invalid EU868 channel plan");
+static_assert(regionPlanValid(US915_PLAN), "invalid US915 channel plan");
+static_assert(regionPlanValid(AU915_PLAN), "invalid AU915 channel plan");
+static_assert(regionPlanValid(AS923_PLAN), "invalid AS923 channel plan");
+
+// the plan of the LMIC region, include after <lmic.h> for its CFG_ flags
+#if defined(CFG_eu868)
+#define REGION_PLAN EU868_PLAN
+#elif defined(CFG_us915)
+#define REGION_PLAN US915_PLAN
+#elif defined(CFG_au915)
+#define REGION_PLAN AU915_PLAN
+#elif defined(CFG_as923)
+#define REGION_PLAN AS923_PLAN
+#endif
+
+#endif
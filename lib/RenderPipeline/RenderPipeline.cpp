@@ -0,0 +1,234 @@
+#include "RenderPipeline.hpp"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <Arduino.h>
+
+static TaskHandle_t renderTaskHandle = NULL;
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+static std::thread renderThread;
+static std::mutex renderMutex;
+static std::condition_variable renderCondition;
+static bool renderPending = false;
+static bool renderStopping = false; // guarded by renderMutex like renderPending
+#endif
+
+RenderPipeline renderPipeline;
+
+#ifdef ARDUINO_ARCH_ESP32
+static void renderTask(void *parameter)
+{
+    RenderPipeline *pipeline = (RenderPipeline *)parameter;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        pipeline->drain();
+    }
+}
+#endif
+
+uint32_t RenderPipeline::now()
+{
+#ifdef ARDUINO_ARCH_ESP32
+    return micros();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+void RenderPipeline::begin(RenderCallback callback)
+{
+    if (running)
+    {
+        return;
+    }
+
+    this->callback = callback;
+    // what was invalidated before the last end() is gone from the screen
+    invalidatedKinds = 0;
+    updated = false;
+    running = true;
+
+#ifdef ARDUINO_ARCH_ESP32
+    xTaskCreatePinnedToCore(renderTask, "render", 4096, this, 1,
+                            &renderTaskHandle, RENDER_TASK_CORE);
+#else
+    renderStopping = false;
+    renderThread = std::thread([this]() {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(renderMutex);
+                renderCondition.wait(lock, []() { return renderPending; });
+                renderPending = false;
+                if (renderStopping)
+                {
+                    return;
+                }
+            }
+            drain();
+        }
+    });
+#endif
+}
+
+void RenderPipeline::end()
+{
+    if (!running)
+    {
+        return;
+    }
+
+#ifdef ARDUINO_ARCH_ESP32
+    // wait for the last snapshot, the display must not be touched while going to sleep
+    while (!idle())
+    {
+        delay(1);
+    }
+    vTaskDelete(renderTaskHandle);
+    renderTaskHandle = NULL;
+    running = false;
+#else
+    {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        renderStopping = true;
+    }
+    wakeup();
+    renderThread.join();
+    // what the thread left behind, it is gone now
+    drain();
+    running = false;
+#endif
+}
+
+void RenderPipeline::wakeup()
+{
+#ifdef ARDUINO_ARCH_ESP32
+    xTaskNotifyGive(renderTaskHandle);
+#else
+    {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        renderPending = true;
+    }
+    renderCondition.notify_one();
+#endif
+}
+
+bool RenderPipeline::submit(StatusSnapshot &snapshot)
+{
+    snapshot.createdUs = now();
+
+    if (!running)
+    {
+        // no render task (yet), draw in the caller's context
+        if (callback != nullptr)
+        {
+            callback(snapshot);
+        }
+        return true;
+    }
+
+    if (!queue.push(snapshot))
+    {
+        statistics.dropped++;
+        return false;
+    }
+
+    wakeup();
+    return true;
+}
+
+void RenderPipeline::invalidate(const StatusSnapshot &snapshot)
+{
+    uint8_t bit = 1 << snapshot.kind;
+
+    if (snapshotClearsScreen(snapshot.kind) && invalidatedKinds != 0)
+    {
+        // the page is drawn on a cleared screen, nothing before it would stay visible
+        for (uint8_t kind = 0; kind < SNAPSHOT_KINDS; kind++)
+        {
+            statistics.merged += (invalidatedKinds >> kind) & 1;
+        }
+        invalidatedKinds = 0;
+    }
+    else if (invalidatedKinds & bit)
+    {
+        statistics.merged++;
+    }
+
+    invalidated[snapshot.kind] = snapshot;
+    invalidatedOrder[snapshot.kind] = invalidations++;
+    invalidatedKinds |= bit;
+}
+
+void RenderPipeline::update()
+{
+    if (timeUntilNextUpdate() != 0)
+    {
+        return;
+    }
+
+    // in the order they were invalidated, an overlay may be newer than the page
+    while (invalidatedKinds != 0)
+    {
+        uint8_t next = SNAPSHOT_KINDS;
+        for (uint8_t kind = 0; kind < SNAPSHOT_KINDS; kind++)
+        {
+            if ((invalidatedKinds & (1 << kind)) &&
+                (next == SNAPSHOT_KINDS || (int32_t)(invalidatedOrder[kind] - invalidatedOrder[next]) < 0))
+            {
+                next = kind;
+            }
+        }
+        invalidatedKinds &= ~(1 << next);
+        submit(invalidated[next]);
+    }
+    lastUpdateUs = now();
+    updated = true;
+}
+
+uint32_t RenderPipeline::timeUntilNextUpdate() const
+{
+    if (invalidatedKinds == 0)
+    {
+        return RENDER_NO_DEADLINE;
+    }
+    uint32_t elapsedMs = (now() - lastUpdateUs) / 1000;
+    if (!updated || elapsedMs >= RENDER_UPDATE_INTERVAL_MS)
+    {
+        return 0;
+    }
+    return RENDER_UPDATE_INTERVAL_MS - elapsedMs;
+}
+
+void RenderPipeline::drain()
+{
+    StatusSnapshot snapshot;
+
+    busy = true;
+    while (queue.pop(snapshot))
+    {
+        uint32_t latency = now() - snapshot.createdUs;
+        statistics.lastLatencyUs = latency;
+        statistics.sumLatencyUs += latency;
+        if (latency > statistics.maxLatencyUs)
+        {
+            statistics.maxLatencyUs = latency;
+        }
+
+        callback(snapshot);
+        statistics.rendered++;
+    }
+    busy = false;
+}
+
+bool RenderPipeline::idle() const
+{
+    return queue.empty() && !busy;
+}
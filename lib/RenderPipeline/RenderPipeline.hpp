@@ -0,0 +1,80 @@
+#ifndef __RENDER_PIPELINE_H__
+#define __RENDER_PIPELINE_H__
+
+#include <stdint.h>
+#include <SpscQueue.hpp>
+#include "StatusSnapshot.hpp"
+
+#ifndef RENDER_QUEUE_SIZE
+#define RENDER_QUEUE_SIZE 8
+#endif
+
+// ESP32 core the render task is pinned to, the Arduino loop() with LMIC runs on core 1
+#ifndef RENDER_TASK_CORE
+#define RENDER_TASK_CORE 0
+#endif
+
+// at most one redraw per interval, invalidations in between are merged
+#ifndef RENDER_UPDATE_INTERVAL_MS
+#define RENDER_UPDATE_INTERVAL_MS 100
+#endif
+
+#define RENDER_NO_DEADLINE UINT32_MAX
+
+typedef void (*RenderCallback)(const StatusSnapshot &snapshot);
+
+struct RenderStatistics
+{
+  uint32_t rendered;
+  uint32_t dropped;
+  uint32_t merged; // invalidations replaced or wiped by a later one before update()
+  uint32_t lastLatencyUs;
+  uint32_t maxLatencyUs;
+  uint64_t sumLatencyUs;
+};
+
+class RenderPipeline
+{
+public:
+  void begin(RenderCallback callback);
+  void end();
+
+  // producer side, never blocks
+  bool submit(StatusSnapshot &snapshot);
+
+  // Producer side, the content changed but nothing is drawn yet. Keeps
+  // the latest snapshot per kind; a page drops the overlays before it.
+  void invalidate(const StatusSnapshot &snapshot);
+  // submits what was invalidated once the update interval allows it, does nothing otherwise
+  void update();
+  // milliseconds until update() has something to draw, RENDER_NO_DEADLINE if nothing was invalidated
+  uint32_t timeUntilNextUpdate() const;
+
+  // consumer side, called by the render task
+  void drain();
+
+  bool idle() const;
+  const RenderStatistics &getStatistics() const { return statistics; }
+
+  static uint32_t now();
+
+private:
+  void wakeup();
+
+  SpscQueue<StatusSnapshot, RENDER_QUEUE_SIZE> queue;
+  // producer side only
+  StatusSnapshot invalidated[SNAPSHOT_KINDS];
+  uint32_t invalidatedOrder[SNAPSHOT_KINDS];
+  uint8_t invalidatedKinds = 0; // bit per kind
+  uint32_t invalidations = 0;
+  uint32_t lastUpdateUs = 0;
+  bool updated = false;
+  RenderCallback callback = nullptr;
+  RenderStatistics statistics = {};
+  volatile bool running = false;
+  volatile bool busy = false;
+};
+
+extern RenderPipeline renderPipeline;
+
+#endif
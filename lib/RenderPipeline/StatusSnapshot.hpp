@@ -0,0 +1,46 @@
+#ifndef __STATUS_SNAPSHOT_H__
+#define __STATUS_SNAPSHOT_H__
+
+#include <stdint.h>
+
+enum SnapshotKind : uint8_t
+{
+  SNAPSHOT_CLEAR,
+  SNAPSHOT_STATUS,
+  SNAPSHOT_ERROR,
+  SNAPSHOT_JOINED,
+  SNAPSHOT_TXCOMPLETE,
+  SNAPSHOT_LINK_STATS
+};
+
+#define SNAPSHOT_KINDS (SNAPSHOT_LINK_STATS + 1)
+
+// a page, drawn on a cleared screen; the others are overlays on part of it
+inline bool snapshotClearsScreen(SnapshotKind kind)
+{
+  return kind == SNAPSHOT_CLEAR || kind == SNAPSHOT_TXCOMPLETE || kind == SNAPSHOT_LINK_STATS;
+}
+
+class LinkStats;
+
+// Everything the display needs, copied when the event happens
+struct StatusSnapshot
+{
+  SnapshotKind kind;
+  uint32_t createdUs;
+  char text[24];
+
+  uint32_t txCounter;
+  uint32_t rxCounter;
+  uint32_t freq;
+  uint16_t bandwidth;
+  uint16_t batteryMv; // 0 = no battery measured
+  int16_t rssi;
+  int8_t snr;
+  uint8_t sf;
+  uint8_t dataLen;
+  // SNAPSHOT_LINK_STATS, read in place by the render task
+  const LinkStats *linkStats;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "RxTiming.hpp"
+
+void RxTiming::reset()
+{
+    for (uint8_t i = 0; i < RX_TIMING_WINDOWS; i++)
+    {
+        windows[i] = RxWindowStatistics();
+    }
+}
+
+void RxTiming::windowOpened(uint8_t window, uint32_t txDoneUs, uint32_t scheduledUs, uint32_t actualUs)
+{
+    if (window >= RX_TIMING_WINDOWS)
+    {
+        return;
+    }
+
+    RxWindowStatistics &statistics = windows[window];
+    int32_t jitter = (int32_t)(actualUs - scheduledUs);
+    uint32_t delay = scheduledUs - txDoneUs;
+
+    if (statistics.count == 0 || jitter < statistics.minJitterUs)
+    {
+        statistics.minJitterUs = jitter;
+    }
+    if (statistics.count == 0 || jitter > statistics.maxJitterUs)
+    {
+        statistics.maxJitterUs = jitter;
+    }
+    if (statistics.count == 0 || delay < statistics.minDelayUs)
+    {
+        statistics.minDelayUs = delay;
+    }
+    if (jitter > 0)
+    {
+        statistics.late++;
+    }
+    statistics.sumJitterUs += jitter;
+    statistics.count++;
+}
+
+int32_t RxTiming::getMeanJitterUs(uint8_t window) const
+{
+    const RxWindowStatistics &statistics = windows[window];
+    return statistics.count ? (int32_t)(statistics.sumJitterUs / statistics.count) : 0;
+}
+
+uint32_t RxTiming::suggestedClockError() const
+{
+    uint32_t result = 0;
+
+    for (uint8_t i = 0; i < RX_TIMING_WINDOWS; i++)
+    {
+        const RxWindowStatistics &statistics = windows[i];
+        // LMIC opens the window earlier by clockError / MAX_CLOCK_ERROR of
+        // the delay, that has to cover the latest opening seen
+        if (statistics.count == 0 || statistics.minDelayUs == 0 || statistics.maxJitterUs <= 0)
+        {
+            continue;
+        }
+        uint64_t error = ((uint64_t)statistics.maxJitterUs * RX_TIMING_MAX_CLOCK_ERROR + statistics.minDelayUs - 1) / statistics.minDelayUs;
+        if (error > result)
+        {
+            result = error > RX_TIMING_MAX_CLOCK_ERROR ? RX_TIMING_MAX_CLOCK_ERROR : (uint32_t)error;
+        }
+    }
+    return result;
+}
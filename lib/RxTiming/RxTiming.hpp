@@ -0,0 +1,47 @@
+#ifndef __RX_TIMING_H__
+#define __RX_TIMING_H__
+
+#include <stdint.h>
+
+#define RX_TIMING_WINDOWS 2
+
+// LMIC_setClockError() units, 100 %
+#define RX_TIMING_MAX_CLOCK_ERROR 65536
+
+struct RxWindowStatistics
+{
+  uint32_t count;
+  uint32_t late;        // opened after the scheduled time
+  int32_t minJitterUs;  // actual - scheduled, negative = early
+  int32_t maxJitterUs;
+  int64_t sumJitterUs;
+  uint32_t minDelayUs;  // scheduled open after TX done
+};
+
+/*
+ * Jitter between the scheduled and the actual RX window open time.
+ * LoRaWANHandler passes the start of LMIC's RX job, due the radio's
+ * ramp-up ahead of the window, so a late job counts as late even while
+ * the ramp-up still hides it. Times are microseconds of any free running 32 bit clock, only
+ * differences are used. Plain C++, the replay tool in
+ * tools/rx_timing_replay uses it on the host.
+ */
+class RxTiming
+{
+public:
+  void reset();
+
+  // window 0 = RX1, 1 = RX2
+  void windowOpened(uint8_t window, uint32_t txDoneUs, uint32_t scheduledUs, uint32_t actualUs);
+
+  const RxWindowStatistics &getStatistics(uint8_t window) const { return windows[window]; }
+  int32_t getMeanJitterUs(uint8_t window) const;
+
+  // smallest clock error that still covers the worst jitter seen, 0 = no data
+  uint32_t suggestedClockError() const;
+
+private:
+  RxWindowStatistics windows[RX_TIMING_WINDOWS];
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include <Arduino.h>
+#include "SampleBuffer.hpp"
+
+RTC_DATA_ATTR SampleBuffer sampleBuffer;
+
+void SampleBuffer::add(const Reading &reading)
+{
+    if (length == SAMPLE_BUFFER_SIZE)
+    {
+        first = (first + 1) % SAMPLE_BUFFER_SIZE;
+        length--;
+        if (pending > 0)
+        {
+            pending--;
+        }
+        dropped++;
+    }
+
+    readings[(first + length) % SAMPLE_BUFFER_SIZE] = reading;
+    length++;
+}
+
+uint8_t SampleBuffer::take(Reading *readings, uint8_t max)
+{
+    uint8_t n = length < max ? length : max;
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        readings[i] = this->readings[(first + i) % SAMPLE_BUFFER_SIZE];
+    }
+    pending = n;
+    return n;
+}
+
+void SampleBuffer::commit()
+{
+    first = (first + pending) % SAMPLE_BUFFER_SIZE;
+    length -= pending;
+    pending = 0;
+}
+
+void SampleBuffer::release()
+{
+    pending = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef __SAMPLE_BUFFER_H__
+#define __SAMPLE_BUFFER_H__
+
+#include <stdint.h>
+#include <Payload.hpp>
+
+#ifndef SAMPLE_BUFFER_SIZE
+#define SAMPLE_BUFFER_SIZE 32
+#endif
+
+// readings per uplink at most, when sampling every SAMPLE_INTERVAL seconds
+#ifndef SAMPLE_BATCH_MAX
+#define SAMPLE_BATCH_MAX 8
+#endif
+
+/*
+ * Readings waiting for the next uplink, kept in RTC memory so they
+ * survive deep sleep. When full the oldest reading is dropped.
+ */
+class SampleBuffer
+{
+public:
+  void add(const Reading &reading);
+
+  // copy up to max of the oldest readings and mark them as pending
+  uint8_t take(Reading *readings, uint8_t max);
+
+  // the pending readings were sent
+  void commit();
+  // the pending readings were not sent, keep them for the next uplink
+  void release();
+
+  uint8_t count() const { return length; }
+  uint32_t getDropped() const { return dropped; }
+
+private:
+  Reading readings[SAMPLE_BUFFER_SIZE];
+  uint8_t first;
+  uint8_t length;
+  uint8_t pending;
+  uint32_t dropped;
+};
+
+extern SampleBuffer sampleBuffer;
+
+#endif
@@ -0,0 +1,162 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <stddef.h>
+#include "SessionStore.hpp"
+
+RTC_DATA_ATTR SessionStore sessionStore;
+
+static Preferences preferences;
+static bool preferencesOpen = false;
+
+static Preferences &openPreferences()
+{
+    if (!preferencesOpen)
+    {
+        preferencesOpen = preferences.begin(PREFERENCE_NAME);
+    }
+    return preferences;
+}
+
+uint32_t SessionStore::restoreSequence()
+{
+    if (!valid)
+    {
+        // cold boot, frames after the last commit may have been sent
+        sequence = openPreferences().getUInt(SEQUENCE_KEY) + SEQUENCE_COMMIT_INTERVAL;
+        commitSequence(sequence);
+        valid = true;
+    }
+    return sequence;
+}
+
+bool SessionStore::storeSequence(uint32_t sequence)
+{
+    this->sequence = sequence;
+    if (sequence - committed < SEQUENCE_COMMIT_INTERVAL)
+    {
+        return false;
+    }
+    commitSequence(sequence);
+    return true;
+}
+
+void SessionStore::commitSequence(uint32_t sequence)
+{
+    openPreferences().putUInt(SEQUENCE_KEY, sequence);
+    committed = sequence;
+    commits++;
+}
+
+uint32_t SessionStore::checksum(const LoRaWANSession &session)
+{
+    const uint8_t *data = (const uint8_t *)&session;
+    uint32_t crc = 0xffffffff;
+
+    for (size_t i = 0; i < offsetof(LoRaWANSession, checksum); i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+void SessionStore::writeSession()
+{
+    openPreferences().putBytes(SESSION_KEY, &session, sizeof(session));
+    sessionCommitted = committed;
+    storedSeqnoDn = session.seqnoDn;
+    commits++;
+}
+
+bool SessionStore::saveSession(bool flash)
+{
+    LoRaWANSession captured;
+
+    // zero the padding, it is part of the checksum
+    memset(&captured, 0, sizeof(captured));
+    captured.version = SESSION_VERSION;
+    LMIC_getSessionKeys(&captured.netid, &captured.devaddr, captured.nwkKey, captured.appKey);
+    captured.seqnoDn = LMIC.seqnoDn;
+#if CFG_LMIC_EU_like
+    memcpy(captured.channelFreq, LMIC.channelFreq, sizeof(captured.channelFreq));
+    memcpy(captured.channelDrMap, LMIC.channelDrMap, sizeof(captured.channelDrMap));
+#endif
+    memcpy(&captured.channelMap, &LMIC.channelMap, sizeof(captured.channelMap));
+    captured.datarate = LMIC.datarate;
+    captured.txPower = LMIC.adrTxPow;
+    captured.dn2Dr = LMIC.dn2Dr;
+    captured.dn2Freq = LMIC.dn2Freq;
+    captured.rxDelay = LMIC.rxDelay;
+    captured.rx1DrOffset = LMIC.rx1DrOffset;
+    captured.checksum = checksum(captured);
+
+    // the fields after seqnoDn only change with MAC commands
+    size_t macState = offsetof(LoRaWANSession, seqnoDn) + sizeof(captured.seqnoDn);
+    bool macChanged = !sessionValid ||
+                      memcmp((const uint8_t *)&captured + macState, (const uint8_t *)&session + macState,
+                             offsetof(LoRaWANSession, checksum) - macState) != 0;
+    session = captured;
+    sessionValid = true;
+
+    if (flash)
+    {
+        // a new session starts counting at 0
+        joins++;
+        writeSession();
+        commitSequence(LMIC.seqnoUp);
+        sequence = LMIC.seqnoUp;
+        valid = true;
+        return true;
+    }
+
+    // MAC changes right away, the downlink counter no more often than the uplink counter
+    if (macChanged || (committed != sessionCommitted && session.seqnoDn != storedSeqnoDn))
+    {
+        writeSession();
+        return true;
+    }
+    return false;
+}
+
+SessionSource SessionStore::restoreSession()
+{
+    SessionSource source = SESSION_RTC;
+
+    if (!sessionValid)
+    {
+        Preferences &preferences = openPreferences();
+        LoRaWANSession stored;
+
+        if (preferences.getBytesLength(SESSION_KEY) != sizeof(stored) ||
+            preferences.getBytes(SESSION_KEY, &stored, sizeof(stored)) != sizeof(stored) ||
+            stored.version != SESSION_VERSION || stored.checksum != checksum(stored))
+        {
+            return SESSION_NONE;
+        }
+        session = stored;
+        sessionValid = true;
+        sessionCommitted = committed;
+        storedSeqnoDn = stored.seqnoDn;
+        source = SESSION_FLASH;
+    }
+
+    // resets the channels, restore them afterwards
+    LMIC_setSession(session.netid, session.devaddr, session.nwkKey, session.appKey);
+#if CFG_LMIC_EU_like
+    memcpy(LMIC.channelFreq, session.channelFreq, sizeof(session.channelFreq));
+    memcpy(LMIC.channelDrMap, session.channelDrMap, sizeof(session.channelDrMap));
+#endif
+    memcpy(&LMIC.channelMap, &session.channelMap, sizeof(session.channelMap));
+    LMIC.seqnoUp = restoreSequence();
+    LMIC.seqnoDn = session.seqnoDn;
+    LMIC.dn2Dr = session.dn2Dr;
+    LMIC.dn2Freq = session.dn2Freq;
+    LMIC.rxDelay = session.rxDelay;
+    LMIC.rx1DrOffset = session.rx1DrOffset;
+    LMIC_setDrTxpow(session.datarate, session.txPower);
+
+    return source;
+}
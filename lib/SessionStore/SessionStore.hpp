@@ -0,0 +1,102 @@
+#ifndef __SESSION_STORE_H__
+#define __SESSION_STORE_H__
+
+#include <stdint.h>
+#include <lmic.h>
+
+#define PREFERENCE_NAME "lmic"
+#define SEQUENCE_KEY "sequence"
+#define SESSION_KEY "session"
+
+// bump when LoRaWANSession changes, older records are ignored
+#define SESSION_VERSION 1
+
+// frames between two flash writes of the uplink frame counter
+#ifndef SEQUENCE_COMMIT_INTERVAL
+#define SEQUENCE_COMMIT_INTERVAL 32
+#endif
+
+// LMIC state needed to continue an OTAA session without joining again
+struct LoRaWANSession
+{
+  uint8_t version;
+  u4_t netid;
+  devaddr_t devaddr;
+  u1_t nwkKey[16];
+  u1_t appKey[16];
+  u4_t seqnoDn;
+#if CFG_LMIC_EU_like
+  decltype(LMIC.channelFreq) channelFreq;
+  decltype(LMIC.channelDrMap) channelDrMap;
+#endif
+  decltype(LMIC.channelMap) channelMap;
+  dr_t datarate;
+  s1_t txPower;
+  u1_t dn2Dr;
+  u4_t dn2Freq;
+  u1_t rxDelay;
+  u1_t rx1DrOffset;
+  uint32_t checksum; // CRC-32 of all fields above
+};
+
+enum SessionSource : uint8_t
+{
+  SESSION_NONE,
+  SESSION_RTC,
+  SESSION_FLASH
+};
+
+/*
+ * LoRaWAN session state kept in RTC memory, so it survives deep sleep
+ * without touching the flash.
+ *
+ * The uplink frame counter is written to NVS only every
+ * SEQUENCE_COMMIT_INTERVAL frames. After a cold boot the stored counter
+ * plus SEQUENCE_COMMIT_INTERVAL is used, which is never below a counter
+ * already sent.
+ *
+ * An OTAA session is saved to RTC memory after every uplink and to NVS
+ * with a checksum, for a restart after a power loss: after the join, as
+ * soon as a MAC command changed data rate, channels or RX parameters,
+ * and along with the frame counter commits if the downlink counter
+ * moved on.
+ */
+class SessionStore
+{
+public:
+  // the uplink frame counter to continue with
+  uint32_t restoreSequence();
+
+  // remember the next uplink frame counter, true if written to flash
+  bool storeSequence(uint32_t sequence);
+
+  // capture the LMIC session, with flash (a new session) also write it to
+  // NVS, true if written to flash
+  bool saveSession(bool flash);
+
+  // continue the saved session, SESSION_NONE if the node has to join
+  SessionSource restoreSession();
+
+  uint32_t getCommits() const { return commits; }
+  uint32_t getJoins() const { return joins; }
+
+private:
+  void commitSequence(uint32_t sequence);
+  void writeSession();
+  static uint32_t checksum(const LoRaWANSession &session);
+
+  bool valid;
+  uint32_t sequence;
+  uint32_t committed;
+  uint32_t commits;
+
+  bool sessionValid;
+  LoRaWANSession session;
+  uint32_t joins;
+  uint32_t sessionCommitted; // committed when the session was last written
+  u4_t storedSeqnoDn; // seqnoDn of the session in flash
+};
+
+extern SessionStore sessionStore;
+
+#endif
@@ -0,0 +1,282 @@
+#include <string.h>
+#include "UplinkScheduler.hpp"
+
+void UplinkScheduler::configure(uint8_t stream, const UplinkStreamConfig &config)
+{
+    if (stream >= UPLINK_STREAMS)
+    {
+        return;
+    }
+    configs[stream] = config;
+    configured |= 1 << stream;
+}
+
+bool UplinkScheduler::submit(uint8_t stream, const uint8_t *data, uint8_t length, uint32_t now)
+{
+    uint8_t bit = 1 << stream;
+    if (stream >= UPLINK_STREAMS || !(configured & bit) || length > UPLINK_STREAM_PAYLOAD_SIZE)
+    {
+        return false;
+    }
+
+    // a payload already handed to LMIC stays as it is
+    if (inFlight & bit)
+    {
+        return false;
+    }
+
+    if (pending & bit)
+    {
+        statistics[stream].replaced++;
+    }
+    else
+    {
+        submittedAt[stream] = now;
+    }
+
+    memcpy(payloads[stream], data, length);
+    lengths[stream] = length;
+    deferred &= ~bit;
+    lastSubmit[stream] = now;
+    submittedOnce |= bit;
+    pending |= bit;
+    statistics[stream].submitted++;
+    return true;
+}
+
+bool UplinkScheduler::withdraw(uint8_t stream, uint8_t *data, uint8_t &length, uint32_t &submittedAt)
+{
+    uint8_t bit = 1 << stream;
+    if (stream >= UPLINK_STREAMS || !(pending & bit))
+    {
+        return false;
+    }
+
+    memcpy(data, payloads[stream], lengths[stream]);
+    length = lengths[stream];
+    submittedAt = this->submittedAt[stream];
+    pending &= ~bit;
+    deferred &= ~bit;
+    return true;
+}
+
+void UplinkScheduler::skip(uint8_t stream, uint32_t now)
+{
+    if (stream >= UPLINK_STREAMS)
+    {
+        return;
+    }
+    lastSubmit[stream] = now;
+    submittedOnce |= 1 << stream;
+    statistics[stream].submitted++;
+}
+
+bool UplinkScheduler::isDue(uint8_t stream, uint32_t now) const
+{
+    uint8_t bit = 1 << stream;
+    if (stream >= UPLINK_STREAMS || !(configured & bit) || configs[stream].period == 0)
+    {
+        return false;
+    }
+    return !(submittedOnce & bit) || now - lastSubmit[stream] >= configs[stream].period;
+}
+
+bool UplinkScheduler::isPending(uint8_t stream) const
+{
+    return stream < UPLINK_STREAMS && (pending & (1 << stream));
+}
+
+uint32_t UplinkScheduler::nextUplink(uint32_t now) const
+{
+    uint32_t next = UPLINK_NONE;
+
+    for (uint8_t stream = 0; stream < UPLINK_STREAMS; stream++)
+    {
+        uint8_t bit = 1 << stream;
+        if (!(configured & bit))
+        {
+            continue;
+        }
+
+        // a deferred payload waits for an uplink it fits into
+        uint32_t due = UPLINK_NONE;
+        if ((pending & bit) && !(deferred & bit))
+        {
+            due = submittedAt[stream] + configs[stream].deadline;
+        }
+        else if (configs[stream].period > 0)
+        {
+            due = (submittedOnce & bit) ? lastSubmit[stream] + configs[stream].period : now;
+        }
+
+        if (due < next)
+        {
+            next = due;
+        }
+    }
+
+    if (next == UPLINK_NONE)
+    {
+        return UPLINK_NONE;
+    }
+    if (next < txAllowedAt)
+    {
+        next = txAllowedAt;
+    }
+    return next > now ? next - now : 0;
+}
+
+size_t UplinkScheduler::build(uint32_t now, uint8_t maxLength, uint8_t &port, uint8_t *buffer)
+{
+    if (inFlight || !pending || now < txAllowedAt)
+    {
+        return 0;
+    }
+
+    // streams that fit by priority, then by the earliest deadline
+    uint8_t order[UPLINK_STREAMS];
+    uint8_t count = 0;
+    for (uint8_t stream = 0; stream < UPLINK_STREAMS; stream++)
+    {
+        uint8_t bit = 1 << stream;
+        if (!(pending & bit))
+        {
+            continue;
+        }
+        if (lengths[stream] > maxLength)
+        {
+            if (!(deferred & bit))
+            {
+                statistics[stream].deferred++;
+                deferred |= bit;
+            }
+            continue;
+        }
+        deferred &= ~bit;
+
+        uint32_t deadline = submittedAt[stream] + configs[stream].deadline;
+        uint8_t i = count++;
+        while (i > 0)
+        {
+            uint8_t other = order[i - 1];
+            uint32_t otherDeadline = submittedAt[other] + configs[other].deadline;
+            if (configs[other].priority < configs[stream].priority ||
+                (configs[other].priority == configs[stream].priority && otherDeadline <= deadline))
+            {
+                break;
+            }
+            order[i] = other;
+            i--;
+        }
+        order[i] = stream;
+    }
+
+    if (count == 0)
+    {
+        return 0;
+    }
+    uint8_t first = order[0];
+
+    // what fits after the most urgent payload, with a header each
+    size_t length = UPLINK_COALESCED_HEADER + lengths[first];
+    uint8_t taken = 1 << first;
+    for (uint8_t i = 1; i < count; i++)
+    {
+        size_t next = length + UPLINK_COALESCED_HEADER + lengths[order[i]];
+        if (next <= maxLength)
+        {
+            length = next;
+            taken |= 1 << order[i];
+        }
+    }
+
+    if (taken == (1 << first))
+    {
+        port = configs[first].port;
+        memcpy(buffer, payloads[first], lengths[first]);
+        length = lengths[first];
+    }
+    else
+    {
+        port = UPLINK_COALESCED_PORT;
+        length = 0;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            uint8_t stream = order[i];
+            if (taken & (1 << stream))
+            {
+                buffer[length++] = configs[stream].port;
+                buffer[length++] = lengths[stream];
+                memcpy(buffer + length, payloads[stream], lengths[stream]);
+                length += lengths[stream];
+            }
+        }
+    }
+
+    pending &= ~taken;
+    inFlight = taken;
+    builtAt = now;
+    return length;
+}
+
+void UplinkScheduler::transmitted(uint32_t now, uint32_t airtimeUs, uint16_t offTimeFactor)
+{
+    uint64_t offUs = (uint64_t)airtimeUs * offTimeFactor;
+    txAllowedAt = now + (uint32_t)((offUs + 999999) / 1000000);
+}
+
+void UplinkScheduler::completed()
+{
+    bool coalesced = (inFlight & (inFlight - 1)) != 0;
+
+    for (uint8_t stream = 0; stream < UPLINK_STREAMS; stream++)
+    {
+        if (!(inFlight & (1 << stream)))
+        {
+            continue;
+        }
+
+        UplinkStreamStatistics &streamStatistics = statistics[stream];
+        uint32_t delay = builtAt - submittedAt[stream];
+        streamStatistics.sent++;
+        streamStatistics.coalesced += coalesced;
+        streamStatistics.lastDelay = delay;
+        streamStatistics.sumDelay += delay;
+        if (delay > streamStatistics.maxDelay)
+        {
+            streamStatistics.maxDelay = delay;
+        }
+        // without a deadline any wait for the duty cycle would count
+        if (configs[stream].deadline > 0 && delay > configs[stream].deadline)
+        {
+            streamStatistics.deadlineMissed++;
+        }
+    }
+
+    lastSent = inFlight;
+    inFlight = 0;
+}
+
+void UplinkScheduler::canceled()
+{
+    // back to the queue, they keep their submit time
+    pending |= inFlight;
+    inFlight = 0;
+}
+
+void UplinkScheduler::retry(uint32_t now, uint32_t delay)
+{
+    for (uint8_t stream = 0; stream < UPLINK_STREAMS; stream++)
+    {
+        if (inFlight & (1 << stream))
+        {
+            statistics[stream].retried++;
+        }
+    }
+    canceled();
+
+    if (now + delay > txAllowedAt)
+    {
+        txAllowedAt = now + delay;
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef __UPLINK_SCHEDULER_H__
+#define __UPLINK_SCHEDULER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define UPLINK_STREAMS 4
+#define UPLINK_STREAM_PAYLOAD_SIZE 64
+#define UPLINK_NONE UINT32_MAX
+
+// FPort of an uplink carrying the payloads of several streams
+#ifndef UPLINK_COALESCED_PORT
+#define UPLINK_COALESCED_PORT 20
+#endif
+
+/*
+ * coalesced uplink on UPLINK_COALESCED_PORT, per payload:
+ *   +0   FPort of the stream
+ *   +1   length
+ *   +2   payload as sent on its own port
+ */
+#define UPLINK_COALESCED_HEADER 2
+
+struct UplinkStreamConfig
+{
+  uint8_t port;
+  uint8_t priority; // 0 is served first
+  uint32_t period;  // seconds between two payloads, 0 = on demand
+  uint32_t deadline; // seconds a payload may wait for an uplink, 0 = due at once, never missed
+};
+
+struct UplinkStreamStatistics
+{
+  uint32_t submitted;
+  uint32_t replaced; // overwritten before it was sent
+  uint32_t sent;
+  uint32_t retried; // sent again, no ack arrived
+  uint32_t coalesced; // sent together with a payload of another stream
+  uint32_t deadlineMissed; // streams with a deadline only
+  uint32_t deferred; // larger than the data rate allowed, waited for one it fits
+  uint32_t lastDelay; // seconds from submit to uplink
+  uint32_t maxDelay;
+  uint64_t sumDelay;
+};
+
+/*
+ * Uplink streams (telemetry, diagnostics, alarms) sharing one LMIC
+ * TX queue. Each stream holds its latest payload. An uplink is needed
+ * when a periodic stream is due or a payload reaches its deadline; it
+ * carries the most urgent payload and, if they fit, the others that
+ * are pending, on UPLINK_COALESCED_PORT. No uplink is started before
+ * the band's duty cycle allows it. A payload larger than the data rate
+ * allows is deferred: it neither blocks the other streams nor makes an
+ * uplink due, and goes out once an uplink runs at a data rate it fits.
+ *
+ * Times are seconds of a clock that keeps running through deep sleep.
+ * Plain C++, the object can live in RTC memory.
+ */
+class UplinkScheduler
+{
+public:
+  // keeps the queued payloads and statistics, stream settings may change at any time
+  void configure(uint8_t stream, const UplinkStreamConfig &config);
+
+  // the stream's payload for the next uplink, replaces an unsent one;
+  // false while the previous one is being sent
+  bool submit(uint8_t stream, const uint8_t *data, uint8_t length, uint32_t now);
+  // take back the stream's unsent payload, false if none is pending
+  bool withdraw(uint8_t stream, uint8_t *data, uint8_t &length, uint32_t &submittedAt);
+  // the stream produced a payload that went elsewhere, its period starts again
+  void skip(uint8_t stream, uint32_t now);
+
+  // a periodic stream wants a new payload
+  bool isDue(uint8_t stream, uint32_t now) const;
+  bool isPending(uint8_t stream) const;
+
+  // seconds until the next uplink is needed, UPLINK_NONE if none is
+  uint32_t nextUplink(uint32_t now) const;
+
+  // payloads for the uplink now, 0 if none fits or the duty cycle does not allow it
+  size_t build(uint32_t now, uint8_t maxLength, uint8_t &port, uint8_t *buffer);
+
+  // TX started with this time on air, the band is busy for airtime times
+  // offTimeFactor (100 = 1 % duty cycle, 0 = none), as LMIC accounts it
+  void transmitted(uint32_t now, uint32_t airtimeUs, uint16_t offTimeFactor);
+  // the built payloads were sent, or go back to the queue
+  void completed();
+  void canceled();
+  // no ack arrived, the built payloads go back to the queue and no uplink starts for delay seconds
+  void retry(uint32_t now, uint32_t delay);
+
+  // streams of the uplink handed to LMIC, bit per stream
+  uint8_t getInFlight() const { return inFlight; }
+  // pending streams too large for the data rate of the last build(), bit per stream
+  uint8_t getDeferred() const { return deferred; }
+
+  // streams of the last completed uplink, bit per stream
+  uint8_t getLastSent() const { return lastSent; }
+  const UplinkStreamStatistics &getStatistics(uint8_t stream) const { return statistics[stream]; }
+
+private:
+  UplinkStreamConfig configs[UPLINK_STREAMS];
+  UplinkStreamStatistics statistics[UPLINK_STREAMS];
+
+  uint8_t payloads[UPLINK_STREAMS][UPLINK_STREAM_PAYLOAD_SIZE];
+  uint8_t lengths[UPLINK_STREAMS];
+  uint32_t submittedAt[UPLINK_STREAMS];
+  uint32_t lastSubmit[UPLINK_STREAMS];
+  uint8_t configured; // bit per stream
+  uint8_t pending;    // bit per stream, waiting for an uplink
+  uint8_t inFlight;   // bit per stream, handed to LMIC
+  uint8_t deferred;   // bit per stream, pending but too large
+  uint8_t submittedOnce;
+  uint8_t lastSent;
+
+  uint32_t builtAt;
+  uint32_t txAllowedAt;
+};
+
+#endif
@@ -0,0 +1,212 @@
+#ifdef HOST_SIM
+
+/*
+ * Runs the firmware on the host against the simulated SX127x of
+ * lib/HostSim, see [env:native] in platformio.ini.
+ *
+ * usage: program [seconds] [host[:port] | -] [delivery percent]
+ *
+ * seconds is virtual time, default 3600. With a host every uplink is
+ * forwarded to a Semtech UDP packet forwarder server there, e.g.
+ * tools/ns_standin. With ABP a simulated network receives each uplink
+ * and ack with the delivery probability, default 100 %, and acks
+ * confirmed uplinks.
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+#include <App.hpp>
+#include <LoRaWANHandler.hpp>
+#include <HostSim.hpp>
+#include <PacketForwarder.hpp>
+#include <SimNetwork.hpp>
+
+// skip to the next LMIC job or radio interrupt, whichever comes first
+static void skipIdleTime()
+{
+    uint64_t target = hostSim.radio.nextEventUs();
+    bit_t deadlineValid = 0;
+    ostime_t deadline = os_getNextDeadline(&deadlineValid);
+
+    if (deadlineValid)
+    {
+        ostime_t delta = deadline - os_getTime();
+        if (delta <= 0)
+        {
+            // a job is runnable
+            return;
+        }
+        uint64_t jobUs = hostSim.nowUs() + osticks2us(delta);
+        if (jobUs < target)
+        {
+            target = jobUs;
+        }
+    }
+
+    if (target != SX127X_NO_EVENT)
+    {
+        hostSim.advanceTo(target);
+    }
+}
+
+// hand a new uplink of the radio to the simulated network and the packet forwarder
+static void forwardUplink(SimNetwork &network, PacketForwarder &forwarder, uint32_t &forwarded)
+{
+    Sx127x &radio = hostSim.radio;
+    if (radio.getStatistics().txCount == forwarded)
+    {
+        return;
+    }
+    forwarded = radio.getStatistics().txCount;
+#ifdef ACTIVATION_MODE_ABP
+    network.uplink(radio.getLastUplink(), radio);
+#endif
+    if (forwarder.isActive())
+    {
+        forwarder.push(radio.getLastUplink(), radio.getLastFrequency(), radio.getLastSpreadingFactor(),
+                       (uint32_t)hostSim.nowUs());
+        forwarder.poll();
+    }
+}
+
+// payloads the firmware produced, a replaced one was never meant to be sent
+static uint32_t producedPayloads()
+{
+    const UplinkScheduler &scheduler = loRaWANHandler.getUplinkScheduler();
+    uint32_t produced = 0;
+    for (uint8_t stream = STREAM_TELEMETRY; stream <= STREAM_ALARM; stream++)
+    {
+        produced += scheduler.getStatistics(stream).submitted - scheduler.getStatistics(stream).replaced;
+    }
+    return produced;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t durationUs = (argc > 1 ? strtoull(argv[1], NULL, 10) : 3600) * 1000000ULL;
+    uint32_t wakeups = 0;
+    bool booted = false;
+    PacketForwarder forwarder;
+    uint32_t forwarded = 0;
+
+    SimNetwork network;
+
+    if (argc > 2 && strcmp(argv[2], "-") != 0 && !forwarder.begin(argv[2]))
+    {
+        return 1;
+    }
+#ifdef ACTIVATION_MODE_ABP
+    {
+        static const uint8_t nwkSKey[16] = TTN_NETWORK_SESSION_KEY;
+        static const uint8_t appSKey[16] = TTN_APP_SESSION_KEY;
+        network.begin(nwkSKey, appSKey, TTN_DEVICE_ADDRESS, argc > 3 ? atoi(argv[3]) : 100);
+    }
+#endif
+
+    hostSim.begin(LMIC_NSS, LMIC_RST, LMIC_DIO0, LMIC_DIO1, LMIC_DIO2);
+    Serial.begin(115200);
+    Serial.println(APP_NAME " - Version " APP_VERSION " host simulation");
+
+    auto wallStart = std::chrono::steady_clock::now();
+
+    while (hostSim.nowUs() < durationUs)
+    {
+        try
+        {
+            if (!booted)
+            {
+                loRaWANHandler.setup();
+                loRaWANHandler.start();
+                booted = true;
+            }
+            loRaWANHandler.runOnce();
+            forwardUplink(network, forwarder, forwarded);
+            skipIdleTime();
+        }
+        catch (const HostSimDeepSleep &sleep)
+        {
+            hostSim.deepSleep(sleep.sleepUs);
+            wakeups++;
+            booted = false;
+        }
+    }
+
+    if (forwarder.isActive())
+    {
+        // give the server a moment for the last PUSH_ACKs
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        forwarder.poll();
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    const Sx127xStatistics &radio = hostSim.radio.getStatistics();
+    const LoRaWANEventStatistics &events = loRaWANHandler.getEventStatistics();
+
+    Serial.printf("\nvirtual time    : %.1f s in %.3f s wall time\n", hostSim.nowUs() / 1e6, wallSeconds);
+    Serial.printf("uplinks         : %u, %.1f ms airtime\n", radio.txCount, radio.txAirtimeUs / 1e3);
+    Serial.printf("rx windows      : %u, %u downlinks, %u timeouts\n", radio.rxWindows, radio.rxDone, radio.rxTimeouts);
+    Serial.printf("deep sleep      : %u wake ups\n", wakeups);
+    Serial.printf("nvs writes      : %u\n", hostSim.nvsWrites);
+    Serial.printf("events          : %u processed, %u dropped, latency max %u us\n",
+                  events.processed, events.dropped, events.maxLatencyUs);
+    const UplinkScheduler &scheduler = loRaWANHandler.getUplinkScheduler();
+    for (uint8_t stream = STREAM_TELEMETRY; stream <= STREAM_BACKLOG; stream++)
+    {
+        const UplinkStreamStatistics &statistics = scheduler.getStatistics(stream);
+        if (statistics.submitted > 0)
+        {
+            Serial.printf("stream %u        : %u sent, %u coalesced, %u replaced, %u late, delay mean %.1f s, max %u s\n",
+                          stream, statistics.sent, statistics.coalesced, statistics.replaced, statistics.deadlineMissed,
+                          statistics.sent ? (double)statistics.sumDelay / statistics.sent : 0.0, statistics.maxDelay);
+        }
+    }
+    const BacklogStatistics &held = backlog.getStatistics();
+    if (held.stored > 0)
+    {
+        Serial.printf("backlog         : %u stored, %u to flash, %u dropped, %u sent, wait mean %.1f s, max %u s\n",
+                      held.stored, held.spilled, held.dropped, held.drained,
+                      held.drained ? (double)held.sumWait / held.drained : 0.0, held.maxWait);
+    }
+
+    const ConfirmedUplink &confirmedUplink = loRaWANHandler.getConfirmedUplink();
+    const ConfirmedStatistics &confirmed = confirmedUplink.getStatistics();
+    if (confirmed.requested > 0)
+    {
+        Serial.printf("confirmed       : %u requested, %u acked, ack rate %u %%, %u retransmitted, %u given up\n",
+                      confirmed.requested, confirmed.acked, confirmedUplink.getAckRate(),
+                      confirmed.retransmitted, confirmed.givenUp);
+    }
+    {
+        const LinkStatsSnapshot &link = loRaWANHandler.getLinkStats().getSnapshot();
+        Serial.printf("link window     : %u uplinks, %u downlinks, %u of %u acked, %u ms airtime mean\n",
+                      link.uplinks, link.rx1 + link.rx2, link.acked, link.ackRequested,
+                      LinkStats::meanAirtimeUs(link) / 1000);
+    }
+#ifdef ACTIVATION_MODE_ABP
+    {
+        const SimNetworkStatistics &received = network.getStatistics();
+        uint32_t produced = producedPayloads();
+        Serial.printf("network         : %u of %u uplinks received at %u %%, %u acks\n",
+                      received.received, received.uplinks, network.getDeliveryPercent(), received.acks);
+        Serial.printf("delivery        : %u of %u payloads (%.1f %%), %.1f ms airtime per delivered payload\n",
+                      received.payloads, produced, produced ? 100.0 * received.payloads / produced : 0.0,
+                      received.payloads ? radio.txAirtimeUs / 1e3 / received.payloads : 0.0);
+    }
+#endif
+    if (forwarder.isActive())
+    {
+        const PacketForwarderStatistics &forwarding = forwarder.getStatistics();
+        Serial.printf("forwarded       : %u uplinks, %u acknowledged\n", forwarding.pushed, forwarding.acked);
+    }
+
+    // a run without a single uplink means the host build is broken, fail the caller
+    if (radio.txCount == 0)
+    {
+        Serial.println("no uplink in the simulated time");
+        return 1;
+    }
+    return 0;
+}
+
+#endif
@@ -1,6 +1,10 @@
+#include <Arduino.h>
 #include <App.hpp>
 #include <LoRaWANHandler.hpp>
+#include <Downlink.hpp>
+#ifdef DISPLAY_ENABLED
 #include <DisplayHandler.hpp>
+#endif
 
 void lora_receive(unsigned long rxFrameCounter)
 {
@@ -15,6 +19,12 @@ void lora_receive(unsigned long rxFrameCounter)
   SERIAL_PRINTLN();
 #endif
 
+  // the port precedes the payload in the frame buffer
+  if ((LMIC.txrxFlags & TXRX_PORT) && LMIC.frame[LMIC.dataBeg - 1] == DOWNLINK_PORT)
+  {
+    loRaWANHandler.processDownlink(&LMIC.frame[LMIC.dataBeg], LMIC.dataLen);
+  }
+
 /*
 #ifdef DISPLAY_ON
   for (int i = 0; i < 8 && i < LMIC.dataLen; i++)
@@ -1,11 +1,18 @@
+#include <Arduino.h>
 #include <App.hpp>
 #include <LoRaWANHandler.hpp>
+#ifdef DISPLAY_ENABLED
 #include <DisplayHandler.hpp>
+#endif
+#include <Payload.hpp>
+#include <SampleBuffer.hpp>
 
 static uint8_t mydata[64];
 
-void lora_send(unsigned long txFrameCounter)
+static void read_sensors(Reading &reading)
 {
+  reading.rssi = LMIC.rssi;
+
 #ifdef ADC_PIN
   float bat_sum = 0;
   for (int i = 0; i < NO_BAT_SAMPLES; i++)
@@ -16,14 +23,40 @@ void lora_send(unsigned long txFrameCounter)
 
   // 3.3 / 4095 * 2 =
   float bat = bat_sum * 6.6 / 4095.0;
-  SERIAL_PRINTF("bat=%.02fV\n", bat);
-  SERIAL_PRINTF("rssi=%d\n", LMIC.rssi);
-  sprintf((char *)mydata, "Fcnt=%ld, bat=%.02fV, rssi=%d", txFrameCounter, bat, LMIC.rssi);
+  reading.batteryMv = bat * 1000;
+  BINLOG(BATTERY, (uint32_t)bat, (uint32_t)(bat * 100) % 100);
+#endif
+  BINLOG(RSSI, LMIC.rssi);
+}
+
+void lora_sample()
+{
+  Reading reading = {};
+  read_sensors(reading);
+  sampleBuffer.add(reading);
+}
+
+void lora_send(unsigned long txFrameCounter)
+{
+  size_t length;
+
+#ifdef SAMPLE_INTERVAL
+  Reading readings[SAMPLE_BATCH_MAX];
+  uint8_t count = loRaWANHandler.batchSize();
+  if (count > payloadBatchCapacity(sizeof(mydata)))
+  {
+    count = payloadBatchCapacity(sizeof(mydata));
+  }
+  count = sampleBuffer.take(readings, count);
+  length = payloadEncodeCompactBatch(mydata, sizeof(mydata), txFrameCounter, SAMPLE_INTERVAL, readings, count);
 #else
-  sprintf((char *)mydata, "Fcnt=%ld, rssi=%d", txFrameCounter, LMIC.rssi);
+  Reading reading = {};
+  reading.counter = txFrameCounter;
+  read_sensors(reading);
+  length = payloadEncodeReading(mydata, sizeof(mydata), reading);
 #endif
 
-  // Prepare upstream data transmission at the next possible time.
-  LMIC_setTxData2(1, mydata, strlen((char *)mydata), 0);
-  SERIAL_PRINTF("%ld Packet queued\n", txFrameCounter);
-}
\ No newline at end of file
+  // sent right away, together with pending diagnostics or alarms if they fit
+  loRaWANHandler.submit(STREAM_TELEMETRY, mydata, length);
+  BINLOG(PACKET_QUEUED, txFrameCounter);
+}
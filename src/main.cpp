@@ -24,6 +24,15 @@ void setup()
     digitalWrite(BUILTIN_LED, LOW);
 #endif
 
+    if (LoRaWANHandler::isWarmWake())
+    {
+        // fast path, no banner and no display: the session, frame counter
+        // and pending readings are in RTC memory, WiFi is still off
+        loRaWANHandler.setup();
+        loRaWANHandler.start();
+        return;
+    }
+
     WiFi.mode(WIFI_OFF); // turn wifi module off
     displayHandler.setup();
     loRaWANHandler.setup();
@@ -57,8 +66,7 @@ void setup()
 #endif
 
 #ifdef DISPLAY_ENABLED
-    display.clear();
-    display.display();
+    displayHandler.clear();
 #endif
 
     loRaWANHandler.start();
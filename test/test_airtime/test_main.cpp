@@ -0,0 +1,115 @@
+#include <unity.h>
+#include <Airtime.hpp>
+
+/*
+ * Reference values from the formula of Semtech AN1200.13 (LoRa Modem
+ * Designer's Guide) as the Semtech LoRa calculator evaluates it: 8
+ * symbol preamble, explicit header, CRC on, low data rate optimisation
+ * for symbols of 16 ms and longer (SF11 and SF12 at 125 kHz).
+ */
+static const uint16_t payloadLengths[] = {1, 13, 23, 51, 64, 115, 222, 255};
+
+static const uint32_t referenceUs[6][8] = {
+    {25856, 46336, 61696, 102656, 118016, 194816, 348416, 399616},          // SF7
+    {51712, 82432, 113152, 184832, 215552, 348672, 614912, 707072},         // SF8
+    {103424, 164864, 205824, 328704, 390144, 615424, 1106944, 1250304},     // SF9
+    {206848, 288768, 370688, 616448, 698368, 1148928, 2009088, 2295808},    // SF10
+    {413696, 577536, 823296, 1314816, 1560576, 2461696, 4427776, 5001216},  // SF11
+    {827392, 1155072, 1482752, 2465792, 2793472, 4431872, 8036352, 9019392} // SF12
+};
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_reference_table_125khz_cr45()
+{
+    for (uint8_t sf = 7; sf <= 12; sf++)
+    {
+        for (uint8_t i = 0; i < sizeof(payloadLengths) / sizeof(payloadLengths[0]); i++)
+        {
+            TEST_ASSERT_EQUAL_UINT32_MESSAGE(referenceUs[sf - 7][i], airtimeUs(sf, 125000, 1, payloadLengths[i]),
+                                             "SF7-SF12 at 125 kHz, CR 4/5");
+        }
+    }
+}
+
+void test_low_data_rate_optimisation()
+{
+    // with DE = 0 SF11 and SF12 would need fewer payload symbols
+    TEST_ASSERT_EQUAL_UINT32(1314816, airtimeUs(11, 125000, 1, 51)); // 1151.0 ms without
+    TEST_ASSERT_EQUAL_UINT32(2465792, airtimeUs(12, 125000, 1, 51)); // 2138.1 ms without
+    // SF12 at 250 kHz has 16.4 ms symbols as well, SF11 at 250 kHz does not
+    TEST_ASSERT_EQUAL_UINT32(1232896, airtimeUs(12, 250000, 1, 51));
+    TEST_ASSERT_EQUAL_UINT32(575488, airtimeUs(11, 250000, 1, 51));
+}
+
+void test_header_and_crc_variants()
+{
+    TEST_ASSERT_EQUAL_UINT32(61696, airtimeUs(7, 125000, 1, 23, true, false));
+    TEST_ASSERT_EQUAL_UINT32(56576, airtimeUs(7, 125000, 1, 23, false, false)); // no CRC
+    TEST_ASSERT_EQUAL_UINT32(56576, airtimeUs(7, 125000, 1, 23, true, true));   // implicit header
+    TEST_ASSERT_EQUAL_UINT32(51456, airtimeUs(7, 125000, 1, 23, false, true));
+    TEST_ASSERT_EQUAL_UINT32(1318912, airtimeUs(12, 125000, 1, 23, false, true));
+    // no payload symbols beyond the 8 of the header block
+    TEST_ASSERT_EQUAL_UINT32(103424, airtimeUs(9, 125000, 1, 0));
+}
+
+void test_coding_rate_bandwidth_and_preamble()
+{
+    TEST_ASSERT_EQUAL_UINT32(1974272, airtimeUs(12, 125000, 4, 23)); // CR 4/8
+    TEST_ASSERT_EQUAL_UINT32(51328, airtimeUs(7, 250000, 1, 51));    // EU868 DR6
+    TEST_ASSERT_EQUAL_UINT32(46208, airtimeUs(8, 500000, 1, 51));    // US915 DR4
+    // each preamble symbol more, 1024 us at SF7
+    TEST_ASSERT_EQUAL_UINT32(46336 + 2 * 1024, airtimeUs(7, 125000, 1, 13, true, false, 10));
+}
+
+void test_budget_interval_spreads_the_budget()
+{
+    AirtimeBudget budget = AirtimeBudget();
+    budget.begin(30000);
+
+    // 30 s a day at 61.7 ms per uplink: one every 177 s
+    TEST_ASSERT_EQUAL_UINT32(177, budget.nextInterval(0, 61696, 60));
+    TEST_ASSERT_EQUAL_UINT32(600, budget.nextInterval(0, 61696, 600));
+}
+
+void test_budget_exhausted_waits_for_old_buckets()
+{
+    AirtimeBudget budget = AirtimeBudget();
+    budget.begin(30000);
+
+    budget.record(0, 29000000);
+    TEST_ASSERT_EQUAL_UINT32(29000, budget.usedMs(0));
+    // 2.47 s do not fit before the first hour leaves the window
+    TEST_ASSERT_EQUAL_UINT32(86400 - 1800, budget.nextInterval(1800, 2465792, 60));
+    TEST_ASSERT_EQUAL_UINT32(0, budget.usedMs(86400));
+}
+
+void test_budget_sub_millisecond_remainder_does_not_underflow()
+{
+    AirtimeBudget budget = AirtimeBudget();
+    budget.begin(1);
+
+    // 1.5 ms in hour 0, 1 ms budget; the remainder must not wrap around
+    // when hour 0 expires, or the wait grows by another hour
+    budget.record(0, 1500);
+    TEST_ASSERT_EQUAL_UINT32(86400 - 3600, budget.nextInterval(3600, 400, 0));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_reference_table_125khz_cr45);
+    RUN_TEST(test_low_data_rate_optimisation);
+    RUN_TEST(test_header_and_crc_variants);
+    RUN_TEST(test_coding_rate_bandwidth_and_preamble);
+    RUN_TEST(test_budget_interval_spreads_the_budget);
+    RUN_TEST(test_budget_exhausted_waits_for_old_buckets);
+    RUN_TEST(test_budget_sub_millisecond_remainder_does_not_underflow);
+    return UNITY_END();
+}
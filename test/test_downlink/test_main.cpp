@@ -0,0 +1,215 @@
+#include <unity.h>
+#include <string.h>
+#include <Downlink.hpp>
+
+// as src/lora_receive.cpp hands LMIC.frame to the parser: MAX_LEN_FRAME
+// bytes, the payload after MHDR, FHDR without FOpts and FPort
+#define FRAME_SIZE 64
+#define FRAME_DATA_BEGIN 9
+
+static uint8_t frame[FRAME_SIZE];
+
+static const DeviceSettings initial = {60, 9, 14, 0, 8, 1};
+
+// copies the payload into the frame buffer, the bytes after it look like
+// valid arguments, so reading past the length would go unnoticed otherwise
+static DownlinkResult apply(const uint8_t *payload, size_t length, DeviceSettings &settings)
+{
+    memset(frame, DOWNLINK_BATCH, sizeof(frame));
+    memcpy(frame + FRAME_DATA_BEGIN, payload, length);
+    return downlinkApply(frame + FRAME_DATA_BEGIN, length, settings);
+}
+
+static void assertRejected(const uint8_t *payload, size_t length, DownlinkStatus status, uint8_t offset)
+{
+    DeviceSettings settings = initial;
+    DownlinkResult result = apply(payload, length, settings);
+
+    TEST_ASSERT_EQUAL_UINT8(status, result.status);
+    TEST_ASSERT_EQUAL_UINT8(0, result.changed);
+    TEST_ASSERT_EQUAL_UINT8(offset, result.offset);
+    // a rejected frame changes nothing, not even its valid commands
+    TEST_ASSERT_EQUAL_MEMORY(&initial, &settings, sizeof(settings));
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_empty_frame()
+{
+    DeviceSettings settings = initial;
+    const uint8_t diagnostics[] = {DOWNLINK_DIAGNOSTICS};
+
+    // a port only frame, the byte in the buffer is not part of it
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_EMPTY, apply(diagnostics, 0, settings).status);
+}
+
+void test_single_commands()
+{
+    DeviceSettings settings = initial;
+
+    const uint8_t interval[] = {DOWNLINK_INTERVAL, 0x0e, 0x10};
+    DownlinkResult result = apply(interval, sizeof(interval), settings);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_OK, result.status);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_CHANGED_INTERVAL, result.changed);
+    TEST_ASSERT_EQUAL_UINT16(3600, settings.interval);
+
+    const uint8_t dataRate[] = {DOWNLINK_DATA_RATE, 12, 2};
+    result = apply(dataRate, sizeof(dataRate), settings);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_CHANGED_DATA_RATE, result.changed);
+    TEST_ASSERT_EQUAL_UINT8(12, settings.spreadingFactor);
+    TEST_ASSERT_EQUAL_INT8(2, settings.txPower);
+
+    const uint8_t adr[] = {DOWNLINK_ADR, 1};
+    result = apply(adr, sizeof(adr), settings);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_CHANGED_ADR, result.changed);
+    TEST_ASSERT_EQUAL_UINT8(1, settings.adr);
+
+    const uint8_t diagnostics[] = {DOWNLINK_DIAGNOSTICS};
+    result = apply(diagnostics, sizeof(diagnostics), settings);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_OK, result.status);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_CHANGED_DIAGNOSTICS, result.changed);
+}
+
+void test_unchanged_values_are_no_change()
+{
+    DeviceSettings settings = initial;
+
+    // display is already on, a repeated display:true must not restart it
+    const uint8_t display[] = {DOWNLINK_DISPLAY, 1};
+    DownlinkResult result = apply(display, sizeof(display), settings);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_OK, result.status);
+    TEST_ASSERT_EQUAL_UINT8(0, result.changed);
+
+    const uint8_t same[] = {DOWNLINK_INTERVAL, 0, 60, DOWNLINK_DATA_RATE, 9, 14, DOWNLINK_BATCH, 8};
+    result = apply(same, sizeof(same), settings);
+    TEST_ASSERT_EQUAL_UINT8(0, result.changed);
+
+    // changed and changed back within one frame
+    const uint8_t back[] = {DOWNLINK_DISPLAY, 0, DOWNLINK_DISPLAY, 1};
+    result = apply(back, sizeof(back), settings);
+    TEST_ASSERT_EQUAL_UINT8(0, result.changed);
+    TEST_ASSERT_EQUAL_MEMORY(&initial, &settings, sizeof(settings));
+
+    const uint8_t off[] = {DOWNLINK_DISPLAY, 0};
+    result = apply(off, sizeof(off), settings);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_CHANGED_DISPLAY, result.changed);
+    TEST_ASSERT_EQUAL_UINT8(0, settings.display);
+}
+
+void test_multiple_commands()
+{
+    DeviceSettings settings = initial;
+    const uint8_t payload[] = {DOWNLINK_INTERVAL, 0x01, 0x2c, DOWNLINK_BATCH, 4,
+                               DOWNLINK_ADR, 1, DOWNLINK_DISPLAY, 0, DOWNLINK_DIAGNOSTICS,
+                               DOWNLINK_DATA_RATE, 7, 10};
+
+    DownlinkResult result = apply(payload, sizeof(payload), settings);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_OK, result.status);
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_CHANGED_SETTINGS | DOWNLINK_CHANGED_DIAGNOSTICS, result.changed);
+    TEST_ASSERT_EQUAL_UINT16(300, settings.interval);
+    TEST_ASSERT_EQUAL_UINT8(4, settings.batchMax);
+    TEST_ASSERT_EQUAL_UINT8(1, settings.adr);
+    TEST_ASSERT_EQUAL_UINT8(0, settings.display);
+    TEST_ASSERT_EQUAL_UINT8(7, settings.spreadingFactor);
+    TEST_ASSERT_EQUAL_INT8(10, settings.txPower);
+
+    // the last of repeated commands wins
+    const uint8_t repeated[] = {DOWNLINK_BATCH, 2, DOWNLINK_BATCH, 3};
+    apply(repeated, sizeof(repeated), settings);
+    TEST_ASSERT_EQUAL_UINT8(3, settings.batchMax);
+}
+
+void test_truncated_arguments()
+{
+    const uint8_t interval[] = {DOWNLINK_INTERVAL, 0x01};
+    assertRejected(interval, sizeof(interval), DOWNLINK_TRUNCATED, 0);
+
+    const uint8_t dataRate[] = {DOWNLINK_DATA_RATE, 9};
+    assertRejected(dataRate, sizeof(dataRate), DOWNLINK_TRUNCATED, 0);
+
+    // valid commands first, the last one cut short
+    const uint8_t tail[] = {DOWNLINK_ADR, 1, DOWNLINK_INTERVAL, 0, 60, DOWNLINK_BATCH};
+    assertRejected(tail, sizeof(tail), DOWNLINK_TRUNCATED, 5);
+
+    const uint8_t display[] = {DOWNLINK_DIAGNOSTICS, DOWNLINK_DISPLAY};
+    assertRejected(display, sizeof(display), DOWNLINK_TRUNCATED, 1);
+}
+
+void test_unknown_commands()
+{
+    const uint8_t zero[] = {0x00};
+    assertRejected(zero, sizeof(zero), DOWNLINK_UNKNOWN_COMMAND, 0);
+
+    const uint8_t next[] = {DOWNLINK_DIAGNOSTICS + 1, 0};
+    assertRejected(next, sizeof(next), DOWNLINK_UNKNOWN_COMMAND, 0);
+
+    const uint8_t afterValid[] = {DOWNLINK_BATCH, 2, 0xff};
+    assertRejected(afterValid, sizeof(afterValid), DOWNLINK_UNKNOWN_COMMAND, 2);
+}
+
+void test_out_of_range()
+{
+    const uint8_t intervalLow[] = {DOWNLINK_INTERVAL, 0, DOWNLINK_INTERVAL_MIN - 1};
+    assertRejected(intervalLow, sizeof(intervalLow), DOWNLINK_OUT_OF_RANGE, 0);
+    const uint8_t intervalHigh[] = {DOWNLINK_INTERVAL, (DOWNLINK_INTERVAL_MAX + 1) >> 8, (DOWNLINK_INTERVAL_MAX + 1) & 0xff};
+    assertRejected(intervalHigh, sizeof(intervalHigh), DOWNLINK_OUT_OF_RANGE, 0);
+
+    const uint8_t sfLow[] = {DOWNLINK_DATA_RATE, DOWNLINK_SF_MIN - 1, 14};
+    assertRejected(sfLow, sizeof(sfLow), DOWNLINK_OUT_OF_RANGE, 0);
+    const uint8_t sfHigh[] = {DOWNLINK_DATA_RATE, DOWNLINK_SF_MAX + 1, 14};
+    assertRejected(sfHigh, sizeof(sfHigh), DOWNLINK_OUT_OF_RANGE, 0);
+    const uint8_t powerLow[] = {DOWNLINK_DATA_RATE, 9, DOWNLINK_TX_POWER_MIN - 1};
+    assertRejected(powerLow, sizeof(powerLow), DOWNLINK_OUT_OF_RANGE, 0);
+    // int8, 0x80 is -128 dBm
+    const uint8_t powerNegative[] = {DOWNLINK_DATA_RATE, 9, 0x80};
+    assertRejected(powerNegative, sizeof(powerNegative), DOWNLINK_OUT_OF_RANGE, 0);
+    const uint8_t powerHigh[] = {DOWNLINK_DATA_RATE, 9, DOWNLINK_TX_POWER_MAX + 1};
+    assertRejected(powerHigh, sizeof(powerHigh), DOWNLINK_OUT_OF_RANGE, 0);
+
+    const uint8_t batchZero[] = {DOWNLINK_BATCH, 0};
+    assertRejected(batchZero, sizeof(batchZero), DOWNLINK_OUT_OF_RANGE, 0);
+    const uint8_t batchHigh[] = {DOWNLINK_INTERVAL, 0, 60, DOWNLINK_BATCH, SAMPLE_BATCH_MAX + 1};
+    assertRejected(batchHigh, sizeof(batchHigh), DOWNLINK_OUT_OF_RANGE, 3);
+
+    const uint8_t adr[] = {DOWNLINK_ADR, 2};
+    assertRejected(adr, sizeof(adr), DOWNLINK_OUT_OF_RANGE, 0);
+    const uint8_t display[] = {DOWNLINK_DISPLAY, 0xff};
+    assertRejected(display, sizeof(display), DOWNLINK_OUT_OF_RANGE, 0);
+}
+
+void test_range_limits_are_accepted()
+{
+    DeviceSettings settings = initial;
+    const uint8_t payload[] = {DOWNLINK_INTERVAL, DOWNLINK_INTERVAL_MAX >> 8, DOWNLINK_INTERVAL_MAX & 0xff,
+                               DOWNLINK_DATA_RATE, DOWNLINK_SF_MIN, DOWNLINK_TX_POWER_MIN,
+                               DOWNLINK_BATCH, 1};
+
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_OK, apply(payload, sizeof(payload), settings).status);
+    TEST_ASSERT_EQUAL_UINT16(DOWNLINK_INTERVAL_MAX, settings.interval);
+
+    const uint8_t upper[] = {DOWNLINK_INTERVAL, 0, DOWNLINK_INTERVAL_MIN,
+                             DOWNLINK_DATA_RATE, DOWNLINK_SF_MAX, DOWNLINK_TX_POWER_MAX,
+                             DOWNLINK_BATCH, SAMPLE_BATCH_MAX};
+    TEST_ASSERT_EQUAL_UINT8(DOWNLINK_OK, apply(upper, sizeof(upper), settings).status);
+    TEST_ASSERT_EQUAL_UINT8(SAMPLE_BATCH_MAX, settings.batchMax);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_frame);
+    RUN_TEST(test_single_commands);
+    RUN_TEST(test_unchanged_values_are_no_change);
+    RUN_TEST(test_multiple_commands);
+    RUN_TEST(test_truncated_arguments);
+    RUN_TEST(test_unknown_commands);
+    RUN_TEST(test_out_of_range);
+    RUN_TEST(test_range_limits_are_accepted);
+    return UNITY_END();
+}
@@ -0,0 +1,63 @@
+#ifndef __GOLDEN_H__
+#define __GOLDEN_H__
+
+#include <Payload.hpp>
+
+/*
+ * Version 3 payloads, counter 0x12345 and interval 600, with what
+ * decodeUplink() of TTNv3/payload_formatter.js returns for them: battery
+ * in mV, 0 = not measured, and rssi per reading. golden.js compares them
+ * with the formatter; after adding a vector run
+ * `node test/test_payload/golden.js --write` to fill in the decoded values.
+ */
+
+static const Reading SINGLE_READINGS[] = {{0, 3700, -97}};
+static const uint8_t SINGLE_PAYLOAD[] = {0x03, 0x01, 0x23, 0x45, 0x02, 0x58, 0x55, 0x00, 0xc1, 0x01, 0x00};
+static const int16_t SINGLE_DECODED[] = {3700, -97};
+
+static const Reading EQUAL_READINGS[] = {{0, 3700, -80}, {1, 3700, -80}, {2, 3700, -80}, {3, 3700, -80}, {4, 3700, -80}, {5, 3700, -80}, {6, 3700, -80}, {7, 3700, -80}, {8, 3700, -80}, {9, 3700, -80}, {10, 3700, -80}, {11, 3700, -80}, {12, 3700, -80}, {13, 3700, -80}, {14, 3700, -80}, {15, 3700, -80}, {16, 3700, -80}, {17, 3700, -80}, {18, 3700, -80}, {19, 3700, -80}, {20, 3700, -80}, {21, 3700, -80}, {22, 3700, -80}, {23, 3700, -80}, {24, 3700, -80}, {25, 3700, -80}, {26, 3700, -80}, {27, 3700, -80}, {28, 3700, -80}, {29, 3700, -80}, {30, 3700, -80}, {31, 3700, -80}, {32, 3700, -80}, {33, 3700, -80}, {34, 3700, -80}, {35, 3700, -80}, {36, 3700, -80}, {37, 3700, -80}, {38, 3700, -80}, {39, 3700, -80}, {40, 3700, -80}, {41, 3700, -80}, {42, 3700, -80}, {43, 3700, -80}, {44, 3700, -80}, {45, 3700, -80}, {46, 3700, -80}, {47, 3700, -80}, {48, 3700, -80}, {49, 3700, -80}, {50, 3700, -80}, {51, 3700, -80}, {52, 3700, -80}, {53, 3700, -80}, {54, 3700, -80}, {55, 3700, -80}, {56, 3700, -80}, {57, 3700, -80}, {58, 3700, -80}, {59, 3700, -80}, {60, 3700, -80}, {61, 3700, -80}, {62, 3700, -80}, {63, 3700, -80}, {64, 3700, -80}, {65, 3700, -80}, {66, 3700, -80}, {67, 3700, -80}, {68, 3700, -80}, {69, 3700, -80}, {70, 3700, -80}, {71, 3700, -80}, {72, 3700, -80}, {73, 3700, -80}, {74, 3700, -80}, {75, 3700, -80}, {76, 3700, -80}, {77, 3700, -80}, {78, 3700, -80}, {79, 3700, -80}, {80, 3700, -80}, {81, 3700, -80}, {82, 3700, -80}, {83, 3700, -80}, {84, 3700, -80}, {85, 3700, -80}, {86, 3700, -80}, {87, 3700, -80}, {88, 3700, -80}, {89, 3700, -80}, {90, 3700, -80}, {91, 3700, -80}, {92, 3700, -80}, {93, 3700, -80}, {94, 3700, -80}, {95, 3700, -80}, {96, 3700, -80}, {97, 3700, -80}, {98, 3700, -80}, {99, 3700, -80}};
+static const uint8_t EQUAL_PAYLOAD[] = {0x03, 0x64, 0x23, 0x45, 0x02, 0x58, 0x55, 0x00, 0x9f, 0x01, 0x00};
+static const int16_t EQUAL_DECODED[] = {3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80, 3700, -80};
+
+static const Reading SLOPE_READINGS[] = {{0, 2100, -20}, {1, 2120, -21}, {2, 2140, -22}, {3, 2160, -23}, {4, 2180, -24}, {5, 2200, -25}, {6, 2220, -26}, {7, 2240, -27}, {8, 2260, -28}, {9, 2280, -29}, {10, 2300, -30}, {11, 2320, -31}, {12, 2340, -32}, {13, 2360, -33}, {14, 2380, -34}, {15, 2400, -35}, {16, 2420, -36}, {17, 2440, -37}, {18, 2460, -38}, {19, 2480, -39}, {20, 2500, -40}, {21, 2520, -41}, {22, 2540, -42}, {23, 2560, -43}, {24, 2580, -44}, {25, 2600, -45}, {26, 2620, -46}, {27, 2640, -47}, {28, 2660, -48}, {29, 2680, -49}, {30, 2700, -50}, {31, 2720, -51}, {32, 2740, -52}, {33, 2760, -53}, {34, 2780, -54}, {35, 2800, -55}, {36, 2820, -56}, {37, 2840, -57}, {38, 2860, -58}, {39, 2880, -59}, {40, 2900, -60}, {41, 2920, -61}, {42, 2940, -62}, {43, 2960, -63}, {44, 2980, -64}, {45, 3000, -65}, {46, 3020, -66}, {47, 3040, -67}, {48, 3060, -68}, {49, 3080, -69}, {50, 3100, -70}, {51, 3120, -71}, {52, 3140, -72}, {53, 3160, -73}, {54, 3180, -74}, {55, 3200, -75}, {56, 3220, -76}, {57, 3240, -77}, {58, 3260, -78}, {59, 3280, -79}, {60, 3300, -80}, {61, 3320, -81}, {62, 3340, -82}, {63, 3360, -83}, {64, 3380, -84}, {65, 3400, -85}, {66, 3420, -86}, {67, 3440, -87}, {68, 3460, -88}, {69, 3480, -89}, {70, 3500, -90}, {71, 3520, -91}, {72, 3540, -92}, {73, 3560, -93}, {74, 3580, -94}, {75, 3600, -95}, {76, 3620, -96}, {77, 3640, -97}, {78, 3660, -98}, {79, 3680, -99}, {80, 3700, -100}, {81, 3720, -101}, {82, 3740, -102}, {83, 3760, -103}, {84, 3780, -104}, {85, 3800, -105}, {86, 3820, -106}, {87, 3840, -107}, {88, 3860, -108}, {89, 3880, -109}, {90, 3900, -110}, {91, 3920, -111}, {92, 3940, -112}, {93, 3960, -113}, {94, 3980, -114}, {95, 4000, -115}, {96, 4020, -116}, {97, 4040, -117}, {98, 4060, -118}, {99, 4080, -119}};
+static const uint8_t SLOPE_PAYLOAD[] = {0x03, 0x64, 0x23, 0x45, 0x02, 0x58, 0x05, 0x02, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xa8, 0x27, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe0};
+static const int16_t SLOPE_DECODED[] = {2100, -20, 2120, -21, 2140, -22, 2160, -23, 2180, -24, 2200, -25, 2220, -26, 2240, -27, 2260, -28, 2280, -29, 2300, -30, 2320, -31, 2340, -32, 2360, -33, 2380, -34, 2400, -35, 2420, -36, 2440, -37, 2460, -38, 2480, -39, 2500, -40, 2520, -41, 2540, -42, 2560, -43, 2580, -44, 2600, -45, 2620, -46, 2640, -47, 2660, -48, 2680, -49, 2700, -50, 2720, -51, 2740, -52, 2760, -53, 2780, -54, 2800, -55, 2820, -56, 2840, -57, 2860, -58, 2880, -59, 2900, -60, 2920, -61, 2940, -62, 2960, -63, 2980, -64, 3000, -65, 3020, -66, 3040, -67, 3060, -68, 3080, -69, 3100, -70, 3120, -71, 3140, -72, 3160, -73, 3180, -74, 3200, -75, 3220, -76, 3240, -77, 3260, -78, 3280, -79, 3300, -80, 3320, -81, 3340, -82, 3360, -83, 3380, -84, 3400, -85, 3420, -86, 3440, -87, 3460, -88, 3480, -89, 3500, -90, 3520, -91, 3540, -92, 3560, -93, 3580, -94, 3600, -95, 3620, -96, 3640, -97, 3660, -98, 3680, -99, 3700, -100, 3720, -101, 3740, -102, 3760, -103, 3780, -104, 3800, -105, 3820, -106, 3840, -107, 3860, -108, 3880, -109, 3900, -110, 3920, -111, 3940, -112, 3960, -113, 3980, -114, 4000, -115, 4020, -116, 4040, -117, 4060, -118, 4080, -119};
+
+static const Reading VARINT_READINGS[] = {{0, 2100, -120}, {1, 2100, -120}, {2, 2100, -120}, {3, 2100, -120}, {4, 2100, -120}, {5, 2100, -120}, {6, 2100, -120}, {7, 2100, -120}, {8, 2100, -120}, {9, 2100, -120}, {10, 2100, -120}, {11, 2100, -120}, {12, 2100, -120}, {13, 2100, -120}, {14, 2100, -120}, {15, 2100, -120}, {16, 2100, -120}, {17, 2100, -120}, {18, 2100, -120}, {19, 2100, -120}, {20, 7000, 100}, {21, 2100, -120}, {22, 2100, -120}, {23, 2100, -120}, {24, 2100, -120}, {25, 2100, -120}, {26, 2100, -120}, {27, 2100, -120}, {28, 2100, -120}, {29, 2100, -120}, {30, 2100, -120}, {31, 2100, -120}, {32, 2100, -120}, {33, 2100, -120}, {34, 2100, -120}, {35, 2100, -120}, {36, 2100, -120}, {37, 2100, -120}, {38, 2100, -120}, {39, 2100, -120}};
+static const uint8_t VARINT_PAYLOAD[] = {0x03, 0x28, 0x23, 0x45, 0x02, 0x58, 0x05, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xea, 0x03, 0xe9, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xef, 0x01, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xb8, 0x03, 0xb7, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const int16_t VARINT_DECODED[] = {2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 7000, 100, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120, 2100, -120};
+
+static const Reading EDGES_READINGS[] = {{0, 0, -250}, {1, 1500, 200}, {2, 2000, -128}, {3, 2010, 127}, {4, 7090, -129}, {5, 8000, 0}, {6, 0, -1}, {7, 3333, 1}};
+static const uint8_t EDGES_PAYLOAD[] = {0x03, 0x08, 0x23, 0x45, 0x02, 0x58, 0xff, 0x01, 0x09, 0xfe, 0x80, 0x00, 0x5f, 0xa0, 0x00, 0x0a, 0xee, 0xff, 0x01, 0x09, 0xff, 0x7f, 0x7f, 0xdf, 0xd8, 0x00, 0x04, 0x08};
+static const int16_t EDGES_DECODED[] = {0, -128, 2000, 127, 2000, -128, 2020, 127, 7080, -128, 7080, 0, 0, -1, 3340, 1};
+
+static const Reading MAXIMUM_READINGS[] = {{0, 7100, 127}, {1, 2001, -128}, {2, 7100, 127}, {3, 2001, -128}, {4, 7100, 127}, {5, 2001, -128}, {6, 7100, 127}, {7, 2001, -128}, {8, 7100, 127}, {9, 2001, -128}, {10, 7100, 127}, {11, 2001, -128}, {12, 7100, 127}, {13, 2001, -128}, {14, 7100, 127}, {15, 2001, -128}, {16, 7100, 127}, {17, 2001, -128}, {18, 7100, 127}, {19, 2001, -128}, {20, 7100, 127}, {21, 2001, -128}, {22, 7100, 127}, {23, 2001, -128}, {24, 7100, 127}, {25, 2001, -128}, {26, 7100, 127}, {27, 2001, -128}, {28, 7100, 127}, {29, 2001, -128}, {30, 7100, 127}, {31, 2001, -128}, {32, 7100, 127}, {33, 2001, -128}, {34, 7100, 127}, {35, 2001, -128}, {36, 7100, 127}, {37, 2001, -128}, {38, 7100, 127}, {39, 2001, -128}, {40, 7100, 127}, {41, 2001, -128}, {42, 7100, 127}, {43, 2001, -128}, {44, 7100, 127}, {45, 2001, -128}, {46, 7100, 127}, {47, 2001, -128}, {48, 7100, 127}, {49, 2001, -128}, {50, 7100, 127}, {51, 2001, -128}, {52, 7100, 127}, {53, 2001, -128}, {54, 7100, 127}, {55, 2001, -128}, {56, 7100, 127}, {57, 2001, -128}, {58, 7100, 127}, {59, 2001, -128}, {60, 7100, 127}, {61, 2001, -128}, {62, 7100, 127}, {63, 2001, -128}, {64, 7100, 127}, {65, 2001, -128}, {66, 7100, 127}, {67, 2001, -128}, {68, 7100, 127}, {69, 2001, -128}, {70, 7100, 127}, {71, 2001, -128}, {72, 7100, 127}, {73, 2001, -128}, {74, 7100, 127}, {75, 2001, -128}, {76, 7100, 127}, {77, 2001, -128}, {78, 7100, 127}, {79, 2001, -128}, {80, 7100, 127}, {81, 2001, -128}, {82, 7100, 127}, {83, 2001, -128}, {84, 7100, 127}, {85, 2001, -128}, {86, 7100, 127}, {87, 2001, -128}, {88, 7100, 127}, {89, 2001, -128}, {90, 7100, 127}, {91, 2001, -128}, {92, 7100, 127}, {93, 2001, -128}, {94, 7100, 127}, {95, 2001, -128}, {96, 7100, 127}, {97, 2001, -128}, {98, 7100, 127}, {99, 2001, -128}, {100, 7100, 127}, {101, 2001, -128}, {102, 7100, 127}, {103, 2001, -128}, {104, 7100, 127}, {105, 2001, -128}, {106, 7100, 127}, {107, 2001, -128}, {108, 7100, 127}, {109, 2001, -128}, {110, 7100, 127}, {111, 2001, -128}, {112, 7100, 127}, {113, 2001, -128}, {114, 7100, 127}, {115, 2001, -128}, {116, 7100, 127}, {117, 2001, -128}, {118, 7100, 127}, {119, 2001, -128}, {120, 7100, 127}, {121, 2001, -128}, {122, 7100, 127}, {123, 2001, -128}, {124, 7100, 127}, {125, 2001, -128}, {126, 7100, 127}, {127, 2001, -128}, {128, 7100, 127}, {129, 2001, -128}, {130, 7100, 127}, {131, 2001, -128}, {132, 7100, 127}, {133, 2001, -128}, {134, 7100, 127}, {135, 2001, -128}, {136, 7100, 127}, {137, 2001, -128}, {138, 7100, 127}, {139, 2001, -128}, {140, 7100, 127}, {141, 2001, -128}, {142, 7100, 127}, {143, 2001, -128}, {144, 7100, 127}, {145, 2001, -128}, {146, 7100, 127}, {147, 2001, -128}, {148, 7100, 127}, {149, 2001, -128}, {150, 7100, 127}, {151, 2001, -128}, {152, 7100, 127}, {153, 2001, -128}, {154, 7100, 127}, {155, 2001, -128}, {156, 7100, 127}, {157, 2001, -128}, {158, 7100, 127}, {159, 2001, -128}, {160, 7100, 127}, {161, 2001, -128}, {162, 7100, 127}, {163, 2001, -128}, {164, 7100, 127}, {165, 2001, -128}, {166, 7100, 127}, {167, 2001, -128}, {168, 7100, 127}, {169, 2001, -128}, {170, 7100, 127}, {171, 2001, -128}, {172, 7100, 127}, {173, 2001, -128}, {174, 7100, 127}, {175, 2001, -128}, {176, 7100, 127}, {177, 2001, -128}, {178, 7100, 127}, {179, 2001, -128}, {180, 7100, 127}, {181, 2001, -128}, {182, 7100, 127}, {183, 2001, -128}, {184, 7100, 127}, {185, 2001, -128}, {186, 7100, 127}, {187, 2001, -128}, {188, 7100, 127}, {189, 2001, -128}, {190, 7100, 127}, {191, 2001, -128}, {192, 7100, 127}, {193, 2001, -128}, {194, 7100, 127}, {195, 2001, -128}, {196, 7100, 127}, {197, 2001, -128}, {198, 7100, 127}, {199, 2001, -128}, {200, 7100, 127}, {201, 2001, -128}, {202, 7100, 127}, {203, 2001, -128}, {204, 7100, 127}, {205, 2001, -128}, {206, 7100, 127}, {207, 2001, -128}, {208, 7100, 127}, {209, 2001, -128}, {210, 7100, 127}, {211, 2001, -128}, {212, 7100, 127}, {213, 2001, -128}, {214, 7100, 127}, {215, 2001, -128}, {216, 7100, 127}, {217, 2001, -128}, {218, 7100, 127}, {219, 2001, -128}, {220, 7100, 127}, {221, 2001, -128}, {222, 7100, 127}, {223, 2001, -128}, {224, 7100, 127}, {225, 2001, -128}, {226, 7100, 127}, {227, 2001, -128}, {228, 7100, 127}, {229, 2001, -128}, {230, 7100, 127}, {231, 2001, -128}, {232, 7100, 127}, {233, 2001, -128}, {234, 7100, 127}, {235, 2001, -128}, {236, 7100, 127}, {237, 2001, -128}, {238, 7100, 127}, {239, 2001, -128}, {240, 7100, 127}, {241, 2001, -128}, {242, 7100, 127}, {243, 2001, -128}, {244, 7100, 127}, {245, 2001, -128}, {246, 7100, 127}, {247, 2001, -128}, {248, 7100, 127}, {249, 2001, -128}, {250, 7100, 127}, {251, 2001, -128}, {252, 7100, 127}, {253, 2001, -128}, {254, 7100, 127}};
+static const uint8_t MAXIMUM_PAYLOAD[] = {0x03, 0xff, 0x23, 0x45, 0x02, 0x58, 0xfe, 0x01, 0x09, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf3, 0xf7, 0xfc, 0xfd, 0xff, 0x3f, 0x7f, 0xcf, 0xdf, 0xf0, 0xfe, 0x01, 0x09, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xfb, 0xfb, 0xfe, 0xfe, 0xff, 0xbf, 0xbf, 0xef, 0xef, 0xf8};
+static const int16_t MAXIMUM_DECODED[] = {7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127, 2000, -128, 7080, 127};
+
+static const Reading RANDOM_READINGS[] = {{0, 4438, 125}, {1, 2588, -212}, {2, 1948, -232}, {3, 2511, -237}, {4, 1079, 25}, {5, 5508, 37}, {6, 2226, 76}, {7, 105, 111}, {8, 283, 28}, {9, 1448, -227}, {10, 5692, -10}, {11, 622, 138}, {12, 4642, -74}, {13, 3110, 36}, {14, 5976, -104}, {15, 4734, -187}, {16, 235, 7}, {17, 3936, -71}, {18, 2663, -144}, {19, 2681, -242}, {20, 6040, 111}, {21, 5173, -114}, {22, 5514, 64}, {23, 6911, 134}, {24, 3656, 142}, {25, 5828, 98}, {26, 4063, -138}, {27, 6192, -115}, {28, 3739, 84}, {29, 1199, -108}, {30, 5383, -124}, {31, 4140, 83}, {32, 6833, 145}, {33, 788, 86}, {34, 3491, -200}, {35, 3219, -7}, {36, 2474, -27}, {37, 7701, -249}, {38, 913, -140}, {39, 7429, 125}, {40, 4965, 80}, {41, 529, 103}, {42, 3634, -218}, {43, 2979, -160}, {44, 6020, -110}, {45, 4199, -235}, {46, 1255, -32}, {47, 1291, -222}, {48, 5990, 91}, {49, 889, -29}, {50, 6606, 48}, {51, 2270, -156}, {52, 6315, -181}, {53, 1893, 112}, {54, 7369, -216}, {55, 764, 68}, {56, 4211, -62}, {57, 1997, -52}, {58, 4278, 6}, {59, 1285, -77}};
+static const uint8_t RANDOM_PAYLOAD[] = {0x03, 0x3c, 0x23, 0x45, 0x02, 0x58, 0x7a, 0x09, 0x5c, 0x8e, 0x46, 0x83, 0x3a, 0xf5, 0x1c, 0x2a, 0x00, 0x00, 0x5c, 0xae, 0x30, 0x84, 0xbc, 0x78, 0xf7, 0x11, 0x61, 0x1f, 0xc0, 0x55, 0x02, 0xa8, 0x89, 0x19, 0x45, 0x6c, 0x2b, 0xda, 0xcf, 0x55, 0x6d, 0x48, 0xf7, 0x0e, 0xf1, 0xa5, 0x83, 0x64, 0x9e, 0x67, 0xef, 0xf8, 0xd3, 0x93, 0xa9, 0x08, 0x33, 0x05, 0xab, 0x6c, 0x01, 0x90, 0xc7, 0xf3, 0x35, 0xf9, 0x4d, 0x7f, 0xf3, 0xf6, 0xde, 0x6e, 0xb9, 0x1c, 0x60, 0xfa, 0x01, 0x09, 0xfc, 0x80, 0x00, 0x13, 0x20, 0xc1, 0x38, 0x8c, 0xa5, 0x9b, 0xbb, 0x22, 0x59, 0x16, 0xe4, 0x5c, 0x5f, 0x0e, 0x4d, 0x9c, 0x40, 0x1d, 0xee, 0x0d, 0x90, 0xfc, 0x00, 0x1c, 0xf0, 0xc3, 0x58, 0xeb, 0xf8, 0x7f, 0x3c, 0x58, 0x28, 0xea, 0xde, 0x42, 0x76, 0x48, 0x03, 0xf4, 0x59, 0x17, 0x73, 0x40, 0x02, 0x41, 0x1b, 0x01, 0x7f, 0xb6, 0x77, 0xa6, 0xab, 0xe0, 0x0f, 0x07, 0x7f, 0x11, 0x03, 0x0a, 0x1d, 0x14, 0xa0};
+static const int16_t RANDOM_DECODED[] = {4440, 125, 2580, -128, 2000, -128, 2520, -128, 2000, 25, 5500, 37, 2220, 76, 2000, 111, 2000, 28, 2000, -128, 5700, -10, 2000, 127, 4640, -74, 3120, 36, 5980, -104, 4740, -128, 2000, 7, 3940, -71, 2660, -128, 2680, -128, 6040, 111, 5180, -114, 5520, 64, 6920, 127, 3660, 127, 5820, 98, 4060, -128, 6200, -115, 3740, 84, 2000, -108, 5380, -124, 4140, 83, 6840, 127, 2000, 86, 3500, -128, 3220, -7, 2480, -27, 7080, -128, 2000, -128, 7080, 125, 4960, 80, 2000, 103, 3640, -128, 2980, -128, 6020, -110, 4200, -128, 2000, -32, 2000, -128, 6000, 91, 2000, -29, 6600, 48, 2280, -128, 6320, -128, 2000, 112, 7080, -128, 2000, 68, 4220, -62, 2000, -52, 4280, 6, 2000, -77};
+
+static const Reading WALK_READINGS[] = {{0, 4574, -192}, {1, 4542, -195}, {2, 4530, -193}, {3, 4512, -192}, {4, 4506, -191}, {5, 4514, -194}, {6, 4501, -194}, {7, 4511, -194}, {8, 4538, -192}, {9, 4569, -194}, {10, 4560, -191}, {11, 4574, -193}, {12, 4583, -192}, {13, 4620, -193}, {14, 4603, -190}, {15, 4634, -191}, {16, 4672, -190}, {17, 4704, -187}, {18, 4703, -187}, {19, 4712, -190}, {20, 4750, -187}, {21, 4765, -190}, {22, 4794, -192}, {23, 4814, -189}, {24, 4775, -186}, {25, 4788, -186}, {26, 4788, -188}, {27, 4823, -188}, {28, 4813, -189}, {29, 4804, -190}, {30, 4820, -193}, {31, 4856, -191}, {32, 4860, -193}, {33, 4872, -190}, {34, 4883, -192}, {35, 4916, -192}, {36, 4898, -193}, {37, 4882, -194}, {38, 4894, -196}, {39, 4891, -194}, {40, 4874, -192}, {41, 4910, -190}, {42, 4929, -190}, {43, 4947, -187}, {44, 4933, -190}, {45, 4954, -189}, {46, 4983, -189}, {47, 4975, -192}, {48, 4946, -194}, {49, 4913, -196}, {50, 4873, -194}, {51, 4848, -192}, {52, 4829, -194}, {53, 4868, -197}, {54, 4881, -195}, {55, 4886, -198}, {56, 4850, -200}, {57, 4836, -203}, {58, 4859, -205}, {59, 4853, -207}};
+static const uint8_t WALK_PAYLOAD[] = {0x03, 0x3c, 0x23, 0x45, 0x02, 0x58, 0x81, 0x01, 0x03, 0x60, 0x94, 0x52, 0x41, 0x08, 0x64, 0x41, 0x41, 0x13, 0x02, 0x02, 0xa0, 0x42, 0x12, 0x81, 0x81, 0x04, 0x83, 0x2d, 0x98, 0x81, 0x28, 0x00, 0xff, 0x01, 0x00};
+static const int16_t WALK_DECODED[] = {4580, -128, 4540, -128, 4540, -128, 4520, -128, 4500, -128, 4520, -128, 4500, -128, 4520, -128, 4540, -128, 4560, -128, 4560, -128, 4580, -128, 4580, -128, 4620, -128, 4600, -128, 4640, -128, 4680, -128, 4700, -128, 4700, -128, 4720, -128, 4760, -128, 4760, -128, 4800, -128, 4820, -128, 4780, -128, 4780, -128, 4780, -128, 4820, -128, 4820, -128, 4800, -128, 4820, -128, 4860, -128, 4860, -128, 4880, -128, 4880, -128, 4920, -128, 4900, -128, 4880, -128, 4900, -128, 4900, -128, 4880, -128, 4920, -128, 4920, -128, 4940, -128, 4940, -128, 4960, -128, 4980, -128, 4980, -128, 4940, -128, 4920, -128, 4880, -128, 4840, -128, 4820, -128, 4860, -128, 4880, -128, 4880, -128, 4860, -128, 4840, -128, 4860, -128, 4860, -128};
+
+struct GoldenVector
+{
+  const char *name;
+  const Reading *readings;
+  uint8_t count;
+  const uint8_t *payload;
+  size_t length;
+  const int16_t *decoded;
+};
+
+#define GOLDEN_VECTOR(name) \
+  {#name, name##_READINGS, sizeof(name##_READINGS) / sizeof(Reading), name##_PAYLOAD, sizeof(name##_PAYLOAD), name##_DECODED}
+
+static const GoldenVector GOLDEN_VECTORS[] = {
+    GOLDEN_VECTOR(SINGLE), GOLDEN_VECTOR(EQUAL), GOLDEN_VECTOR(SLOPE), GOLDEN_VECTOR(VARINT),
+    GOLDEN_VECTOR(EDGES), GOLDEN_VECTOR(MAXIMUM), GOLDEN_VECTOR(RANDOM), GOLDEN_VECTOR(WALK)};
+
+#endif
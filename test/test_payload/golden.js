@@ -0,0 +1,67 @@
+// Decodes the payloads of golden.h with decodeUplink() of
+// TTNv3/payload_formatter.js and compares the readings with the decoded
+// values the C++ test checks against the encoder.
+//
+//   node test/test_payload/golden.js          compare, exit 1 on a mismatch
+//   node test/test_payload/golden.js --write  fill in the decoded values
+
+var fs = require("fs");
+var path = require("path");
+var vm = require("vm");
+
+var root = path.join(__dirname, "..", "..");
+var goldenPath = path.join(__dirname, "golden.h");
+var formatter = {};
+
+vm.runInNewContext(fs.readFileSync(path.join(root, "TTNv3", "payload_formatter.js"), "utf8"), formatter);
+
+function parseArray(text) {
+  return text.trim() === "" ? [] : text.split(",").map(function (value) {
+    return parseInt(value, value.trim().indexOf("0x") === 0 ? 16 : 10);
+  });
+}
+
+// battery in mV, 0 = not measured, and rssi per reading
+function decode(payload) {
+  var decoded = [];
+  var data = formatter.decodeUplink({ fPort: 1, bytes: payload }).data;
+
+  (data.readings || []).forEach(function (reading) {
+    decoded.push(reading.battery === undefined ? 0 : Math.round(reading.battery * 1000), reading.rssi);
+  });
+  return decoded;
+}
+
+var write = process.argv.indexOf("--write") >= 0;
+var lines = fs.readFileSync(goldenPath, "utf8").split("\n");
+var payloads = {};
+var vectors = 0;
+var mismatches = 0;
+
+lines = lines.map(function (line) {
+  var match = /^static const \w+ (\w+)_(PAYLOAD|DECODED)\[\] = \{(.*)\};$/.exec(line);
+  if (!match) {
+    return line;
+  }
+  if (match[2] === "PAYLOAD") {
+    payloads[match[1]] = parseArray(match[3]);
+    return line;
+  }
+
+  var expected = decode(payloads[match[1]]);
+  vectors++;
+  if (write) {
+    return line.replace(/\{.*\}/, "{" + expected.join(", ") + "}");
+  }
+  if (parseArray(match[3]).join() !== expected.join()) {
+    console.log(match[1] + ": the formatter decodes " + expected.join(", "));
+    mismatches++;
+  }
+  return line;
+});
+
+if (write) {
+  fs.writeFileSync(goldenPath, lines.join("\n"));
+}
+console.log(vectors + " vectors, " + mismatches + " mismatches");
+process.exit(mismatches ? 1 : 0);
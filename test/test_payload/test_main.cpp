@@ -0,0 +1,197 @@
+#include <unity.h>
+#include <Payload.hpp>
+#include "golden.h"
+
+#define MAX_BATCH UINT8_MAX
+
+static uint8_t buffer[PAYLOAD_BATCH_HEADER_SIZE + 2 * (5 + 1 + 3 * MAX_BATCH)];
+
+// the mode byte of the series at offset, it follows the first value, a varint
+static uint8_t seriesMode(size_t offset)
+{
+    while (buffer[offset] & 0x80)
+    {
+        offset++;
+    }
+    return buffer[offset + 1];
+}
+
+// the offset after the series at offset, skips the values without decoding them
+static size_t seriesEnd(size_t offset, uint8_t count)
+{
+    uint8_t mode = seriesMode(offset);
+    while (buffer[offset] & 0x80)
+    {
+        offset++;
+    }
+    offset += 2;
+    if (mode != PAYLOAD_DELTA_VARINT)
+    {
+        return offset + ((count - 1) * mode + 7) / 8;
+    }
+    for (uint8_t i = 1; i < count; i++)
+    {
+        while (buffer[offset] & 0x80)
+        {
+            offset++;
+        }
+        offset++;
+    }
+    return offset;
+}
+
+// encodes as version 3, checks the header and returns the length
+static size_t encode(const Reading *readings, uint8_t count, uint8_t *batteryMode = NULL, uint8_t *rssiMode = NULL)
+{
+    size_t length = payloadEncodeDeltaBatch(buffer, sizeof(buffer), 0x12345, 600, readings, count);
+    TEST_ASSERT_NOT_EQUAL(0, length);
+    TEST_ASSERT_EQUAL_UINT8(PAYLOAD_VERSION_DELTA_BATCH, buffer[0]);
+    TEST_ASSERT_EQUAL_UINT8(count, buffer[1]);
+    TEST_ASSERT_EQUAL_UINT16(0x2345, (buffer[2] << 8) | buffer[3]);
+    TEST_ASSERT_EQUAL_UINT16(600, (buffer[4] << 8) | buffer[5]);
+
+    size_t rssiOffset = seriesEnd(PAYLOAD_BATCH_HEADER_SIZE, count);
+    TEST_ASSERT_EQUAL_UINT32(length, seriesEnd(rssiOffset, count));
+    if (batteryMode)
+    {
+        *batteryMode = seriesMode(PAYLOAD_BATCH_HEADER_SIZE);
+    }
+    if (rssiMode)
+    {
+        *rssiMode = seriesMode(rssiOffset);
+    }
+    return length;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// the encoder still writes the golden payloads, and what the formatter
+// decodes from them is what the encoder was given, within its resolution
+void test_golden_vectors()
+{
+    for (size_t v = 0; v < sizeof(GOLDEN_VECTORS) / sizeof(GOLDEN_VECTORS[0]); v++)
+    {
+        const GoldenVector &vector = GOLDEN_VECTORS[v];
+
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(vector.length, encode(vector.readings, vector.count), vector.name);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(vector.payload, buffer, vector.length, vector.name);
+
+        for (uint8_t i = 0; i < vector.count; i++)
+        {
+            uint8_t battery = payloadEncodeBattery(vector.readings[i].batteryMv);
+            int16_t batteryMv = battery == PAYLOAD_BATTERY_UNKNOWN
+                                    ? 0
+                                    : PAYLOAD_BATTERY_OFFSET_MV + battery * PAYLOAD_BATTERY_STEP_MV;
+            TEST_ASSERT_EQUAL_INT16_MESSAGE(batteryMv, vector.decoded[2 * i], vector.name);
+            TEST_ASSERT_EQUAL_INT16_MESSAGE(payloadEncodeRssi(vector.readings[i].rssi), vector.decoded[2 * i + 1], vector.name);
+        }
+    }
+}
+
+void test_single_reading()
+{
+    Reading reading = {1, 3700, -97};
+    uint8_t batteryMode;
+    uint8_t rssiMode;
+
+    // first values and a mode byte, no deltas; zigzag -97 needs two varint bytes
+    TEST_ASSERT_EQUAL_UINT32(PAYLOAD_BATCH_HEADER_SIZE + 1 + 1 + 2 + 1, encode(&reading, 1, &batteryMode, &rssiMode));
+    TEST_ASSERT_EQUAL_UINT8(0, batteryMode);
+    TEST_ASSERT_EQUAL_UINT8(0, rssiMode);
+}
+
+void test_equal_deltas()
+{
+    Reading readings[MAX_BATCH];
+    uint8_t batteryMode;
+    uint8_t rssiMode;
+
+    // no change at all packs into zero bits
+    for (uint8_t i = 0; i < 100; i++)
+    {
+        readings[i] = {i, 3700, -80};
+    }
+    size_t length = encode(readings, 100, &batteryMode, &rssiMode);
+    TEST_ASSERT_EQUAL_UINT8(0, batteryMode);
+    TEST_ASSERT_EQUAL_UINT8(0, rssiMode);
+    TEST_ASSERT_EQUAL_UINT32(PAYLOAD_BATCH_HEADER_SIZE + 3 + 2, length);
+
+    // a steady slope, zigzag 2 needs 2 bits, zigzag 1 one
+    for (uint8_t i = 0; i < 100; i++)
+    {
+        readings[i] = {i, (uint16_t)(2100 + 20 * i), (int16_t)(-20 - i)};
+    }
+    length = encode(readings, 100, &batteryMode, &rssiMode);
+    TEST_ASSERT_EQUAL_UINT8(2, batteryMode);
+    TEST_ASSERT_EQUAL_UINT8(1, rssiMode);
+    TEST_ASSERT_EQUAL_UINT32(PAYLOAD_BATCH_HEADER_SIZE + 1 + 1 + (99 * 2 + 7) / 8 + 1 + 1 + (99 + 7) / 8, length);
+}
+
+void test_varint_fallback()
+{
+    Reading readings[MAX_BATCH];
+    uint8_t batteryMode;
+    uint8_t rssiMode;
+
+    // one large jump would widen every packed delta to 9 bits
+    for (uint8_t i = 0; i < 40; i++)
+    {
+        readings[i] = {i, (uint16_t)(i == 20 ? 7000 : 2100), (int16_t)(i == 20 ? 100 : -120)};
+    }
+    encode(readings, 40, &batteryMode, &rssiMode);
+    TEST_ASSERT_EQUAL_UINT8(PAYLOAD_DELTA_VARINT, batteryMode);
+    TEST_ASSERT_EQUAL_UINT8(PAYLOAD_DELTA_VARINT, rssiMode);
+}
+
+void test_maximum_batch()
+{
+    Reading readings[MAX_BATCH];
+
+    // the widest deltas in the largest batch, alternating extremes
+    for (uint16_t i = 0; i < MAX_BATCH; i++)
+    {
+        readings[i] = {i, (uint16_t)(i % 2 ? 2001 : 7100), (int16_t)(i % 2 ? -128 : 127)};
+    }
+    size_t length = encode(readings, MAX_BATCH);
+    TEST_ASSERT_TRUE(length <= sizeof(buffer));
+
+    // a buffer one byte short is refused, not overrun
+    TEST_ASSERT_EQUAL_UINT32(0, payloadEncodeDeltaBatch(buffer, length - 1, 0, 600, readings, MAX_BATCH));
+}
+
+void test_compact_batch_takes_the_shorter()
+{
+    Reading readings[MAX_BATCH];
+
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        readings[i] = {i, 3700, -80};
+    }
+    TEST_ASSERT_EQUAL_UINT32(PAYLOAD_BATCH_HEADER_SIZE + 5, payloadEncodeCompactBatch(buffer, sizeof(buffer), 0, 600, readings, 10));
+    TEST_ASSERT_EQUAL_UINT8(PAYLOAD_VERSION_DELTA_BATCH, buffer[0]);
+
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        readings[i] = {i, (uint16_t)(i % 2 ? 2001 : 7100), (int16_t)(i % 2 ? -128 : 127)};
+    }
+    TEST_ASSERT_EQUAL_UINT32(payloadBatchSize(10), payloadEncodeCompactBatch(buffer, sizeof(buffer), 0, 600, readings, 10));
+    TEST_ASSERT_EQUAL_UINT8(PAYLOAD_VERSION_BATCH, buffer[0]);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_golden_vectors);
+    RUN_TEST(test_single_reading);
+    RUN_TEST(test_equal_deltas);
+    RUN_TEST(test_varint_fallback);
+    RUN_TEST(test_maximum_batch);
+    RUN_TEST(test_compact_batch_takes_the_shorter);
+    return UNITY_END();
+}
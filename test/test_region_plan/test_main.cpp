@@ -0,0 +1,162 @@
+#include <unity.h>
+#include <Airtime.hpp>
+#include <RegionPlan.hpp>
+
+/*
+ * Reference values from the LoRaWAN Regional Parameters (RP002-1.0.3),
+ * with the choices The Things Network makes where they leave one: RX2
+ * data rate, US915 and AU915 sub-band, EU868 repeater compatible
+ * payloads.
+ */
+struct DataRate
+{
+    uint8_t spreadingFactor; // 0 = FSK or not defined
+    uint32_t bandwidthHz;
+};
+
+static const DataRate EU868_DATA_RATES[] = {
+    {12, 125000}, {11, 125000}, {10, 125000}, {9, 125000}, {8, 125000}, {7, 125000}, {7, 250000}, {0, 0}};
+static const DataRate US915_DATA_RATES[] = {
+    {10, 125000}, {9, 125000}, {8, 125000}, {7, 125000}, {8, 500000}, {0, 0}, {0, 0}, {0, 0}};
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void assertPayloads(const RegionPlan &plan, const uint8_t *expected)
+{
+    for (uint8_t dataRate = 0; dataRate < REGION_DATA_RATES; dataRate++)
+    {
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE(expected[dataRate], plan.maxPayload[dataRate], "maximum payload N per data rate");
+    }
+}
+
+// the largest frame of every data rate stays within the dwell time
+static void assertDwellTime(const RegionPlan &plan, const DataRate *dataRates)
+{
+    for (uint8_t dataRate = 0; dataRate < REGION_DATA_RATES; dataRate++)
+    {
+        if (plan.maxPayload[dataRate] == 0 || dataRates[dataRate].spreadingFactor == 0)
+        {
+            continue;
+        }
+        uint32_t airtime = airtimeUs(dataRates[dataRate].spreadingFactor, dataRates[dataRate].bandwidthHz, 1,
+                                     LORAWAN_FRAME_OVERHEAD + plan.maxPayload[dataRate]);
+        TEST_ASSERT_TRUE_MESSAGE(airtime <= plan.dwellTimeMs * 1000UL, "largest frame exceeds the dwell time");
+    }
+}
+
+void test_eu868()
+{
+    static const uint32_t frequencies[] = {868100000, 868300000, 868500000, 867100000, 867300000,
+                                           867500000, 867700000, 867900000, 868800000};
+    static const uint8_t payloads[] = {51, 51, 51, 115, 222, 222, 222, 222};
+
+    TEST_ASSERT_EQUAL_UINT8(9, EU868_PLAN.channelCount);
+    for (uint8_t channel = 0; channel < EU868_PLAN.channelCount; channel++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(frequencies[channel], EU868_PLAN.channels[channel].frequency);
+    }
+    // 868.3 MHz also carries SF7BW250, 868.8 MHz is FSK in the 0.1 % band
+    TEST_ASSERT_EQUAL_UINT8(6, EU868_PLAN.channels[1].maxDataRate);
+    TEST_ASSERT_EQUAL_UINT8(7, EU868_PLAN.channels[8].minDataRate);
+    TEST_ASSERT_EQUAL_UINT8(REGION_BAND_MILLI, EU868_PLAN.channels[8].band);
+
+    TEST_ASSERT_EQUAL_UINT8(3, EU868_PLAN.rx2DataRate);
+    TEST_ASSERT_EQUAL_UINT32(869525000, EU868_PLAN.rx2Frequency);
+    assertPayloads(EU868_PLAN, payloads);
+
+    TEST_ASSERT_EQUAL_UINT16(100, regionOffTimeFactor(EU868_PLAN, 868100000));
+    TEST_ASSERT_EQUAL_UINT16(100, regionOffTimeFactor(EU868_PLAN, 867900000));
+    TEST_ASSERT_EQUAL_UINT16(1000, regionOffTimeFactor(EU868_PLAN, 868800000));
+}
+
+void test_us915_sub_band_2()
+{
+    static const uint8_t payloads[] = {11, 53, 125, 242, 242, 0, 0, 0};
+
+    // the channels LMIC_selectSubBand() enables: 125 kHz 8 to 15 and 500 kHz 65
+    TEST_ASSERT_EQUAL_UINT8(1, US915_PLAN.subBand);
+    TEST_ASSERT_EQUAL_UINT8(0, US915_PLAN.channelCount);
+    TEST_ASSERT_TRUE(regionSubBandMask(US915_PLAN) == 0xff00ULL);
+    TEST_ASSERT_EQUAL_UINT32(903900000, regionChannelFrequency(US915_PLAN, 8));
+    TEST_ASSERT_EQUAL_UINT32(905300000, regionChannelFrequency(US915_PLAN, 15));
+    TEST_ASSERT_EQUAL_UINT32(904600000, regionWideChannelFrequency(US915_PLAN));
+
+    TEST_ASSERT_EQUAL_UINT8(0, US915_PLAN.slowestDataRate); // SF10
+    TEST_ASSERT_EQUAL_UINT8(3, US915_PLAN.fastestDataRate); // SF7
+    TEST_ASSERT_EQUAL_UINT8(8, US915_PLAN.rx2DataRate); // SF12 at 500 kHz
+    TEST_ASSERT_EQUAL_UINT32(923300000, US915_PLAN.rx2Frequency);
+    assertPayloads(US915_PLAN, payloads);
+
+    TEST_ASSERT_EQUAL_UINT16(400, US915_PLAN.dwellTimeMs);
+    assertDwellTime(US915_PLAN, US915_DATA_RATES);
+    TEST_ASSERT_EQUAL_UINT16(0, regionOffTimeFactor(US915_PLAN, 903900000));
+}
+
+void test_au915_sub_band_2()
+{
+    static const uint8_t payloads[] = {51, 51, 51, 115, 242, 242, 242, 0};
+
+    TEST_ASSERT_EQUAL_UINT8(1, AU915_PLAN.subBand);
+    TEST_ASSERT_TRUE(regionSubBandMask(AU915_PLAN) == 0xff00ULL);
+    TEST_ASSERT_EQUAL_UINT32(916800000, regionChannelFrequency(AU915_PLAN, 8));
+    TEST_ASSERT_EQUAL_UINT32(918200000, regionChannelFrequency(AU915_PLAN, 15));
+    TEST_ASSERT_EQUAL_UINT32(917500000, regionWideChannelFrequency(AU915_PLAN));
+    TEST_ASSERT_EQUAL_UINT8(0, AU915_PLAN.slowestDataRate); // SF12
+    TEST_ASSERT_EQUAL_UINT8(5, AU915_PLAN.fastestDataRate); // SF7
+    TEST_ASSERT_EQUAL_UINT8(8, AU915_PLAN.rx2DataRate);
+    TEST_ASSERT_EQUAL_UINT32(923300000, AU915_PLAN.rx2Frequency);
+    assertPayloads(AU915_PLAN, payloads);
+
+    // no dwell time limit until a TxParamSetupReq sets one
+    TEST_ASSERT_EQUAL_UINT16(0, AU915_PLAN.dwellTimeMs);
+    TEST_ASSERT_EQUAL_UINT16(0, regionOffTimeFactor(AU915_PLAN, 916800000));
+}
+
+void test_as923_dwell_time()
+{
+    static const uint32_t frequencies[] = {923200000, 923400000, 922200000, 922400000,
+                                           922600000, 922800000, 923000000, 922000000};
+    // UplinkDwellTime = 1: no DR0 and DR1, as LMIC assumes before a TxParamSetupReq
+    static const uint8_t payloads[] = {0, 0, 11, 53, 125, 242, 242, 242};
+
+    TEST_ASSERT_EQUAL_UINT8(8, AS923_PLAN.channelCount);
+    for (uint8_t channel = 0; channel < AS923_PLAN.channelCount; channel++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(frequencies[channel], AS923_PLAN.channels[channel].frequency);
+    }
+    TEST_ASSERT_EQUAL_UINT8(2, AS923_PLAN.slowestDataRate); // SF10
+    TEST_ASSERT_EQUAL_UINT8(2, AS923_PLAN.rx2DataRate);
+    TEST_ASSERT_EQUAL_UINT32(923200000, AS923_PLAN.rx2Frequency);
+    assertPayloads(AS923_PLAN, payloads);
+
+    TEST_ASSERT_EQUAL_UINT16(400, AS923_PLAN.dwellTimeMs);
+    // same modulation per data rate as EU868
+    assertDwellTime(AS923_PLAN, EU868_DATA_RATES);
+    TEST_ASSERT_EQUAL_UINT16(100, regionOffTimeFactor(AS923_PLAN, 923200000));
+}
+
+void test_plans_are_valid()
+{
+    TEST_ASSERT_TRUE(regionPlanValid(EU868_PLAN));
+    TEST_ASSERT_TRUE(regionPlanValid(US915_PLAN));
+    TEST_ASSERT_TRUE(regionPlanValid(AU915_PLAN));
+    TEST_ASSERT_TRUE(regionPlanValid(AS923_PLAN));
+    TEST_ASSERT_TRUE(regionSubBandMask(EU868_PLAN) == 0);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_eu868);
+    RUN_TEST(test_us915_sub_band_2);
+    RUN_TEST(test_au915_sub_band_2);
+    RUN_TEST(test_as923_dwell_time);
+    RUN_TEST(test_plans_are_valid);
+    return UNITY_END();
+}
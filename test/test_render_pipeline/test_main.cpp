@@ -0,0 +1,186 @@
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <RenderPipeline.hpp>
+
+#define SNAPSHOTS 20000
+
+static std::vector<uint32_t> rendered;
+static uint32_t renderDelayUs = 0;
+
+static void record(const StatusSnapshot &snapshot)
+{
+    rendered.push_back(snapshot.txCounter);
+    if (renderDelayUs > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(renderDelayUs));
+    }
+}
+
+// txCounter numbers the snapshots, returns those the queue took
+static std::vector<uint32_t> submitAll(RenderPipeline &pipeline, uint32_t count)
+{
+    std::vector<uint32_t> accepted;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        StatusSnapshot snapshot = {};
+        snapshot.kind = SNAPSHOT_TXCOMPLETE;
+        snapshot.txCounter = i;
+        if (pipeline.submit(snapshot))
+        {
+            accepted.push_back(i);
+        }
+    }
+    return accepted;
+}
+
+void setUp()
+{
+    rendered.clear();
+    renderDelayUs = 0;
+}
+
+void tearDown()
+{
+}
+
+void test_renders_in_order_and_counts_drops()
+{
+    RenderPipeline pipeline;
+    pipeline.begin(record);
+    renderDelayUs = 5;
+
+    std::vector<uint32_t> accepted = submitAll(pipeline, SNAPSHOTS);
+    pipeline.end();
+
+    const RenderStatistics &statistics = pipeline.getStatistics();
+    TEST_ASSERT_EQUAL_UINT32(accepted.size(), statistics.rendered);
+    TEST_ASSERT_EQUAL_UINT32(SNAPSHOTS, statistics.rendered + statistics.dropped);
+    // a slow consumer makes the producer drop, it never blocks
+    TEST_ASSERT_GREATER_THAN_UINT32(0, statistics.dropped);
+    TEST_ASSERT_TRUE(rendered == accepted);
+}
+
+void test_end_waits_until_idle()
+{
+    RenderPipeline pipeline;
+    pipeline.begin(record);
+    renderDelayUs = 2000;
+
+    std::vector<uint32_t> accepted = submitAll(pipeline, RENDER_QUEUE_SIZE);
+    pipeline.end();
+
+    TEST_ASSERT_TRUE(pipeline.idle());
+    TEST_ASSERT_EQUAL_UINT32(accepted.size(), rendered.size());
+    TEST_ASSERT_EQUAL_UINT32(RENDER_QUEUE_SIZE, rendered.size());
+}
+
+void test_draws_in_caller_context_before_begin()
+{
+    RenderPipeline pipeline;
+    std::vector<uint32_t> accepted = submitAll(pipeline, 3);
+    TEST_ASSERT_EQUAL_UINT32(3, accepted.size());
+    TEST_ASSERT_EQUAL_UINT32(0, rendered.size()); // no callback yet
+}
+
+static StatusSnapshot snapshotOf(SnapshotKind kind, uint32_t txCounter)
+{
+    StatusSnapshot snapshot = {};
+    snapshot.kind = kind;
+    snapshot.txCounter = txCounter;
+    return snapshot;
+}
+
+void test_update_draws_nothing_until_invalidated()
+{
+    RenderPipeline pipeline;
+    pipeline.begin(record);
+
+    TEST_ASSERT_EQUAL_UINT32(RENDER_NO_DEADLINE, pipeline.timeUntilNextUpdate());
+    pipeline.update();
+    pipeline.invalidate(snapshotOf(SNAPSHOT_STATUS, 1));
+    TEST_ASSERT_EQUAL_UINT32(0, pipeline.timeUntilNextUpdate());
+    pipeline.update();
+    pipeline.update();
+    pipeline.end();
+
+    TEST_ASSERT_EQUAL_UINT32(1, rendered.size());
+    TEST_ASSERT_EQUAL_UINT32(1, pipeline.getStatistics().rendered);
+}
+
+void test_invalidations_merge_until_the_deadline()
+{
+    RenderPipeline pipeline;
+    pipeline.begin(record);
+
+    pipeline.invalidate(snapshotOf(SNAPSHOT_STATUS, 1));
+    pipeline.update();
+
+    // the latest per kind, a page wipes the overlays before it
+    pipeline.invalidate(snapshotOf(SNAPSHOT_STATUS, 2));
+    pipeline.invalidate(snapshotOf(SNAPSHOT_ERROR, 3));
+    pipeline.invalidate(snapshotOf(SNAPSHOT_TXCOMPLETE, 4));
+    pipeline.invalidate(snapshotOf(SNAPSHOT_STATUS, 5));
+    pipeline.invalidate(snapshotOf(SNAPSHOT_STATUS, 6));
+
+    uint32_t waitMs = pipeline.timeUntilNextUpdate();
+    TEST_ASSERT_TRUE(waitMs > 0 && waitMs <= RENDER_UPDATE_INTERVAL_MS);
+    // too early, nothing is submitted
+    pipeline.update();
+    TEST_ASSERT_NOT_EQUAL(RENDER_NO_DEADLINE, pipeline.timeUntilNextUpdate());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(waitMs + 1));
+    TEST_ASSERT_EQUAL_UINT32(0, pipeline.timeUntilNextUpdate());
+    pipeline.update();
+    pipeline.end();
+
+    std::vector<uint32_t> expected = {1, 4, 6};
+    TEST_ASSERT_TRUE(rendered == expected);
+    TEST_ASSERT_EQUAL_UINT32(3, pipeline.getStatistics().merged);
+    TEST_ASSERT_EQUAL_UINT32(RENDER_NO_DEADLINE, pipeline.timeUntilNextUpdate());
+}
+
+// submit cost on the LMIC side and submit to render latency, informational
+void test_benchmark()
+{
+    RenderPipeline pipeline;
+    pipeline.begin(record);
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < SNAPSHOTS; i++)
+    {
+        StatusSnapshot snapshot = {};
+        snapshot.txCounter = i;
+        accepted += pipeline.submit(snapshot);
+        if (i % RENDER_QUEUE_SIZE == 0)
+        {
+            // an LMIC job gap, lets the render thread catch up
+            std::this_thread::yield();
+        }
+    }
+    double submitNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    pipeline.end();
+
+    const RenderStatistics &statistics = pipeline.getStatistics();
+    char message[160];
+    snprintf(message, sizeof(message), "%u snapshots: %.0f ns per submit, %u rendered, %u dropped, latency mean %u us, max %u us",
+             SNAPSHOTS, submitNs / SNAPSHOTS, statistics.rendered, statistics.dropped,
+             statistics.rendered ? (uint32_t)(statistics.sumLatencyUs / statistics.rendered) : 0, statistics.maxLatencyUs);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(accepted, statistics.rendered);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_renders_in_order_and_counts_drops);
+    RUN_TEST(test_end_waits_until_idle);
+    RUN_TEST(test_draws_in_caller_context_before_begin);
+    RUN_TEST(test_update_draws_nothing_until_invalidated);
+    RUN_TEST(test_invalidations_merge_until_the_deadline);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,117 @@
+#include <unity.h>
+#include <stdint.h>
+#include <thread>
+#include <SpscQueue.hpp>
+
+#define STRESS_ITEMS 500000
+
+// the fields are written separately, a torn copy breaks the check
+struct Item
+{
+    uint32_t sequence;
+    uint32_t check;
+    uint8_t padding[24];
+};
+
+static uint32_t checkOf(uint32_t sequence)
+{
+    return sequence * 2654435761u;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_fifo_and_capacity()
+{
+    SpscQueue<int, 4> queue;
+    int value;
+
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_FALSE(queue.pop(value));
+    for (int i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_TRUE(queue.push(i));
+    }
+    TEST_ASSERT_FALSE(queue.push(4));
+    TEST_ASSERT_EQUAL_UINT32(4, queue.size());
+
+    for (int i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_TRUE(queue.pop(value));
+        TEST_ASSERT_EQUAL_INT(i, value);
+    }
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_wraps_around()
+{
+    SpscQueue<int, 4> queue;
+    int value;
+
+    // head and tail pass the capacity many times
+    for (int i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_TRUE(queue.push(i));
+        TEST_ASSERT_TRUE(queue.push(i + 1));
+        TEST_ASSERT_TRUE(queue.pop(value));
+        TEST_ASSERT_EQUAL_INT(i, value);
+        TEST_ASSERT_TRUE(queue.pop(value));
+        TEST_ASSERT_EQUAL_INT(i + 1, value);
+    }
+}
+
+// one producer and one consumer thread, nothing lost, duplicated, reordered or torn
+void test_two_thread_stress()
+{
+    static SpscQueue<Item, 8> queue;
+
+    std::thread producer([]() {
+        for (uint32_t sequence = 0; sequence < STRESS_ITEMS; sequence++)
+        {
+            Item item;
+            item.sequence = sequence;
+            item.check = checkOf(sequence);
+            while (!queue.push(item))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+    while (expected < STRESS_ITEMS)
+    {
+        Item item;
+        if (!queue.pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (item.sequence != expected || item.check != checkOf(item.sequence))
+        {
+            errors++;
+            expected = item.sequence;
+        }
+        expected++;
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    TEST_ASSERT_EQUAL_UINT32(STRESS_ITEMS, expected);
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_and_capacity);
+    RUN_TEST(test_wraps_around);
+    RUN_TEST(test_two_thread_stress);
+    return UNITY_END();
+}
@@ -0,0 +1,56 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <App.hpp>
+#include <HostSim.hpp>
+#include <LoRaWANHandler.hpp>
+
+// src/ is not part of the test build
+void lora_sample()
+{
+}
+
+void lora_send(unsigned long txFrameCounter)
+{
+}
+
+void lora_receive(unsigned long rxFrameCounter)
+{
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// no EV_TXCOMPLETE follows a canceled frame, the handler must start the next cycle itself
+void test_next_cycle_is_scheduled()
+{
+    bit_t deadlineValid = 0;
+
+    loRaWANHandler.setup();
+    os_getNextDeadline(&deadlineValid);
+    TEST_ASSERT_FALSE(deadlineValid);
+
+    onEvent(EV_TXCANCELED);
+    loRaWANHandler.processEvents();
+
+    // the send job, or the sleep job right away with DEEP_SLEEP_ENABLED
+    ostime_t deadline = os_getNextDeadline(&deadlineValid);
+    TEST_ASSERT_TRUE(deadlineValid);
+    TEST_ASSERT_TRUE(deadline - os_getTime() <= sec2osticks(TRANSMIT_INTERVAL));
+    TEST_ASSERT_EQUAL_UINT32(1, loRaWANHandler.getEventStatistics().processed);
+    // nothing was in flight, nothing to park
+    TEST_ASSERT_TRUE(backlog.empty());
+}
+
+int main(int argc, char **argv)
+{
+    hostSim.begin(LMIC_NSS, LMIC_RST, LMIC_DIO0, LMIC_DIO1, LMIC_DIO2);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_next_cycle_is_scheduled);
+    return UNITY_END();
+}
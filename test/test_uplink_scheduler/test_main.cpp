@@ -0,0 +1,151 @@
+#include <unity.h>
+#include <string.h>
+#include <UplinkScheduler.hpp>
+
+#define TELEMETRY 0
+#define DIAGNOSTICS 1
+#define ALARM 2
+
+// US915 DR0
+#define SMALLEST_PAYLOAD 11
+
+static UplinkScheduler scheduler;
+static uint8_t buffer[UPLINK_STREAMS * (UPLINK_COALESCED_HEADER + UPLINK_STREAM_PAYLOAD_SIZE)];
+static uint8_t payload[UPLINK_STREAM_PAYLOAD_SIZE];
+
+void setUp()
+{
+    scheduler = UplinkScheduler();
+    UplinkStreamConfig telemetry = {1, 1, 600, 60};
+    UplinkStreamConfig diagnostics = {11, 2, 0, 0};
+    UplinkStreamConfig alarm = {12, 0, 0, 0};
+    scheduler.configure(TELEMETRY, telemetry);
+    scheduler.configure(DIAGNOSTICS, diagnostics);
+    scheduler.configure(ALARM, alarm);
+    memset(payload, 0x5a, sizeof(payload));
+}
+
+void tearDown()
+{
+}
+
+void test_oversized_payload_does_not_block_the_others()
+{
+    uint8_t port;
+
+    // a v2 diagnostics frame, most urgent by its deadline
+    TEST_ASSERT_TRUE(scheduler.submit(DIAGNOSTICS, payload, 44, 0));
+    TEST_ASSERT_TRUE(scheduler.submit(TELEMETRY, payload, 5, 0));
+
+    TEST_ASSERT_EQUAL_UINT32(5, scheduler.build(0, SMALLEST_PAYLOAD, port, buffer));
+    TEST_ASSERT_EQUAL_UINT8(1, port);
+    TEST_ASSERT_EQUAL_UINT8(1 << TELEMETRY, scheduler.getInFlight());
+    TEST_ASSERT_EQUAL_UINT8(1 << DIAGNOSTICS, scheduler.getDeferred());
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStatistics(DIAGNOSTICS).deferred);
+    TEST_ASSERT_TRUE(scheduler.isPending(DIAGNOSTICS));
+    scheduler.completed();
+}
+
+void test_oversized_payload_alone_is_not_due()
+{
+    uint8_t port;
+
+    // telemetry was never submitted, it is due now
+    TEST_ASSERT_TRUE(scheduler.submit(DIAGNOSTICS, payload, 44, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.nextUplink(0));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.build(0, SMALLEST_PAYLOAD, port, buffer));
+
+    // then only its period counts, not the deferred diagnostics
+    scheduler.skip(TELEMETRY, 0);
+    TEST_ASSERT_EQUAL_UINT32(600, scheduler.nextUplink(0));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.build(10, SMALLEST_PAYLOAD, port, buffer));
+    // counted once, not on every attempt
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStatistics(DIAGNOSTICS).deferred);
+}
+
+void test_deferred_payload_goes_out_at_a_faster_data_rate()
+{
+    uint8_t port;
+
+    TEST_ASSERT_TRUE(scheduler.submit(DIAGNOSTICS, payload, 44, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.build(0, SMALLEST_PAYLOAD, port, buffer));
+
+    TEST_ASSERT_EQUAL_UINT32(44, scheduler.build(5, 53, port, buffer));
+    TEST_ASSERT_EQUAL_UINT8(11, port);
+    TEST_ASSERT_EQUAL_UINT8(0, scheduler.getDeferred());
+    scheduler.completed();
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStatistics(DIAGNOSTICS).sent);
+}
+
+void test_coalesces_what_fits()
+{
+    uint8_t port;
+
+    TEST_ASSERT_TRUE(scheduler.submit(ALARM, payload, 3, 0));
+    TEST_ASSERT_TRUE(scheduler.submit(TELEMETRY, payload, 5, 0));
+    TEST_ASSERT_TRUE(scheduler.submit(DIAGNOSTICS, payload, 44, 0));
+
+    // alarm and telemetry with their headers take 12 of 53 bytes, diagnostics would need 46 more
+    TEST_ASSERT_EQUAL_UINT32(12, scheduler.build(0, 53, port, buffer));
+    TEST_ASSERT_EQUAL_UINT8(UPLINK_COALESCED_PORT, port);
+    TEST_ASSERT_EQUAL_UINT8(12, buffer[0]);
+    TEST_ASSERT_EQUAL_UINT8(3, buffer[1]);
+    TEST_ASSERT_EQUAL_UINT8(1, buffer[5]);
+    TEST_ASSERT_EQUAL_UINT8(5, buffer[6]);
+    // it fits on its own, so it is not deferred
+    TEST_ASSERT_EQUAL_UINT8(0, scheduler.getDeferred());
+}
+
+void test_duty_cycle_off_time()
+{
+    uint8_t port;
+
+    TEST_ASSERT_TRUE(scheduler.submit(ALARM, payload, 3, 0));
+    scheduler.build(0, 51, port, buffer);
+    // 1.5 s on air at 1 %, the band is busy for 150 s
+    scheduler.transmitted(0, 1500000, 100);
+    scheduler.completed();
+
+    TEST_ASSERT_TRUE(scheduler.submit(ALARM, payload, 3, 10));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.build(10, 51, port, buffer));
+    TEST_ASSERT_EQUAL_UINT32(140, scheduler.nextUplink(10));
+    TEST_ASSERT_EQUAL_UINT32(3, scheduler.build(150, 51, port, buffer));
+    scheduler.completed();
+
+    // no duty cycle, e.g. US915
+    scheduler.transmitted(150, 1500000, 0);
+    TEST_ASSERT_TRUE(scheduler.submit(ALARM, payload, 3, 150));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.nextUplink(150));
+    TEST_ASSERT_EQUAL_UINT32(3, scheduler.build(150, 11, port, buffer));
+}
+
+void test_deadline_missed()
+{
+    uint8_t port;
+
+    TEST_ASSERT_TRUE(scheduler.submit(ALARM, payload, 3, 0));
+    scheduler.build(0, 51, port, buffer);
+    scheduler.transmitted(0, 1500000, 100);
+    scheduler.completed();
+
+    // both wait 150 s for the duty cycle, only telemetry has a deadline to miss
+    TEST_ASSERT_TRUE(scheduler.submit(ALARM, payload, 3, 0));
+    TEST_ASSERT_TRUE(scheduler.submit(TELEMETRY, payload, 5, 0));
+    TEST_ASSERT_EQUAL_UINT32(UPLINK_COALESCED_HEADER * 2 + 8, scheduler.build(150, 51, port, buffer));
+    scheduler.completed();
+    TEST_ASSERT_EQUAL_UINT32(150, scheduler.getStatistics(ALARM).lastDelay);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getStatistics(ALARM).deadlineMissed);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStatistics(TELEMETRY).deadlineMissed);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_oversized_payload_does_not_block_the_others);
+    RUN_TEST(test_oversized_payload_alone_is_not_due);
+    RUN_TEST(test_deferred_payload_goes_out_at_a_faster_data_rate);
+    RUN_TEST(test_coalesces_what_fits);
+    RUN_TEST(test_duty_cycle_off_time);
+    RUN_TEST(test_deadline_missed);
+    return UNITY_END();
+}
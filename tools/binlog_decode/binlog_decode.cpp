@@ -0,0 +1,79 @@
+/*
+ * Decodes a raw serial capture of a firmware built with
+ * BINLOG_ENABLED and BINLOG_RAW_OUTPUT.
+ *
+ * build: g++ -std=c++11 -I../../lib/BinLog -o binlog_decode binlog_decode.cpp
+ * usage: binlog_decode capture.bin   (or read from stdin)
+ *
+ * Bytes outside of valid records (boot banner, ROM messages) are
+ * passed through unchanged.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <BinLogFormats.h>
+
+static uint32_t readUInt32(const uint8_t *data)
+{
+  return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+int main(int argc, char *argv[])
+{
+  FILE *input = stdin;
+  if (argc > 1)
+  {
+    input = fopen(argv[1], "rb");
+    if (input == NULL)
+    {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), input)) > 0)
+  {
+    data.insert(data.end(), chunk, chunk + n);
+  }
+
+  static const char *const formats[] = {BINLOG_FORMATS(BINLOG_FORMAT_STRING)};
+  const size_t headerSize = sizeof(BinLogHeader);
+  unsigned long records = 0;
+  size_t i = 0;
+
+  while (i < data.size())
+  {
+    const uint8_t *p = &data[i];
+    size_t left = data.size() - i;
+
+    if (left >= headerSize && p[0] == BINLOG_SYNC && p[1] < BINLOG_FORMAT_COUNT &&
+        p[2] <= BINLOG_MAX_ARGS && p[3] == (p[1] ^ p[2] ^ BINLOG_SYNC) &&
+        left >= headerSize + p[2] * 4)
+    {
+      uint32_t args[BINLOG_MAX_ARGS] = {0};
+      for (int a = 0; a < p[2]; a++)
+      {
+        args[a] = readUInt32(p + headerSize + a * 4);
+      }
+
+      printf("[%10u] ", readUInt32(p + 4));
+      printf(formats[p[1]], args[0], args[1], args[2], args[3],
+             args[4], args[5], args[6], args[7]);
+
+      i += headerSize + p[2] * 4;
+      records++;
+    }
+    else
+    {
+      putchar(p[0]);
+      i++;
+    }
+  }
+
+  fprintf(stderr, "%lu records decoded\n", records);
+  return 0;
+}
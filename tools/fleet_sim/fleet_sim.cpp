@@ -0,0 +1,345 @@
+/*
+ * Time accelerated simulation of many nodes sharing one gateway.
+ *
+ * build: g++ -std=c++11 -O2 -pthread -I../../lib/Airtime -o fleet_sim fleet_sim.cpp ../../lib/Airtime/Airtime.cpp
+ * usage: fleet_sim [--nodes 1000] [--hours 24] [--interval 60] [--interval-max 60]
+ *                  [--sf 7 | --sf-mix 7:40,8:20,9:15,10:10,11:10,12:5]
+ *                  [--payload 5] [--budget-ms 30000] [--threads N] [--seed 1]
+ *
+ * Every node behaves like the firmware: an uplink every interval
+ * seconds after the previous TX/RX cycle, stretched by the 24 h
+ * AirtimeBudget and the 1 % duty cycle of the EU868 g band, on a random
+ * one of the 8 channels set up in LoRaWANHandler::setup(). Node clocks
+ * drift by up to +-20 ppm.
+ *
+ * Two uplinks collide if they overlap in time on the same channel with
+ * the same spreading factor; both are lost, there is no capture effect.
+ * Schedules are generated per node and collisions resolved per channel,
+ * each on all host cores.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <Airtime.hpp>
+
+#define CHANNELS 8
+#define MIN_SF 7
+#define MAX_SF 12
+#define SF_COUNT (MAX_SF - MIN_SF + 1)
+
+// RX1 1 s and RX2 2 s after TX, LMIC reschedules after EV_TXCOMPLETE
+#define RX_WINDOWS_US 2000000ULL
+#define DUTY_CYCLE_FACTOR 100
+#define CLOCK_DRIFT_PPM 20
+
+struct Options
+{
+  uint32_t nodes = 1000;
+  uint32_t hours = 24;
+  uint32_t interval = 60;
+  uint32_t intervalMax = 0;
+  uint32_t sfShare[SF_COUNT] = {100, 0, 0, 0, 0, 0};
+  uint32_t payload = 5;
+  uint32_t budgetMs = 30000;
+  uint32_t threads = 0;
+  uint32_t seed = 1;
+};
+
+struct Uplink
+{
+  uint64_t startUs;
+  uint64_t endUs;
+  uint32_t node;
+  uint8_t sf;
+  bool lost;
+};
+
+typedef std::vector<Uplink> Channel;
+
+struct SfStatistics
+{
+  uint64_t sent;
+  uint64_t delivered;
+  uint64_t airtimeUs;
+  uint32_t nodes;
+};
+
+static bool parseSfMix(const char *text, uint32_t *share)
+{
+  memset(share, 0, sizeof(uint32_t) * SF_COUNT);
+  while (*text)
+  {
+    unsigned sf, percent;
+    int consumed;
+    if (sscanf(text, "%u:%u%n", &sf, &percent, &consumed) != 2 || sf < MIN_SF || sf > MAX_SF)
+    {
+      return false;
+    }
+    share[sf - MIN_SF] = percent;
+    text += consumed;
+    if (*text == ',')
+    {
+      text++;
+    }
+  }
+  return true;
+}
+
+static bool parseOptions(int argc, char *argv[], Options &options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    const char *name = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (value == NULL)
+    {
+      return false;
+    }
+    i++;
+
+    if (!strcmp(name, "--nodes"))
+      options.nodes = atoi(value);
+    else if (!strcmp(name, "--hours"))
+      options.hours = atoi(value);
+    else if (!strcmp(name, "--interval"))
+      options.interval = atoi(value);
+    else if (!strcmp(name, "--interval-max"))
+      options.intervalMax = atoi(value);
+    else if (!strcmp(name, "--sf"))
+    {
+      unsigned sf = atoi(value);
+      if (sf < MIN_SF || sf > MAX_SF)
+        return false;
+      memset(options.sfShare, 0, sizeof(options.sfShare));
+      options.sfShare[sf - MIN_SF] = 100;
+    }
+    else if (!strcmp(name, "--sf-mix"))
+    {
+      if (!parseSfMix(value, options.sfShare))
+        return false;
+    }
+    else if (!strcmp(name, "--payload"))
+      options.payload = atoi(value);
+    else if (!strcmp(name, "--budget-ms"))
+      options.budgetMs = atoi(value);
+    else if (!strcmp(name, "--threads"))
+      options.threads = atoi(value);
+    else if (!strcmp(name, "--seed"))
+      options.seed = atoi(value);
+    else
+      return false;
+  }
+  return options.nodes > 0 && options.interval > 0;
+}
+
+static uint8_t pickSf(const Options &options, std::mt19937 &random)
+{
+  uint32_t total = 0;
+  for (int i = 0; i < SF_COUNT; i++)
+  {
+    total += options.sfShare[i];
+  }
+  uint32_t pick = random() % (total ? total : 1);
+  for (int i = 0; i < SF_COUNT; i++)
+  {
+    if (pick < options.sfShare[i])
+    {
+      return MIN_SF + i;
+    }
+    pick -= options.sfShare[i];
+  }
+  return MIN_SF;
+}
+
+// uplinks of nodes [first, last), sorted into channels
+static void scheduleNodes(const Options &options, uint32_t first, uint32_t last,
+                          Channel *channels, uint8_t *nodeSf)
+{
+  uint64_t endUs = options.hours * 3600ULL * 1000000ULL;
+  uint16_t frameLength = LORAWAN_FRAME_OVERHEAD + options.payload;
+
+  for (uint32_t node = first; node < last; node++)
+  {
+    std::mt19937 random(options.seed * 2654435761U + node);
+    uint8_t sf = pickSf(options, random);
+    uint32_t interval = options.interval;
+    if (options.intervalMax > options.interval)
+    {
+      interval += random() % (options.intervalMax - options.interval + 1);
+    }
+    double drift = 1.0 + ((int32_t)(random() % (2 * CLOCK_DRIFT_PPM + 1)) - CLOCK_DRIFT_PPM) / 1e6;
+    uint32_t airtime = airtimeUs(sf, 125000, 1, frameLength);
+
+    AirtimeBudget budget = AirtimeBudget();
+    budget.begin(options.budgetMs);
+
+    nodeSf[node] = sf;
+
+    // nodes are powered on at random times within one cycle
+    uint32_t firstCycle = AirtimeBudget(budget).nextInterval(0, airtime, interval);
+    uint64_t t = (uint64_t)(random() % (firstCycle * 1000ULL)) * 1000;
+    while (t < endUs)
+    {
+      Uplink uplink = {t, t + airtime, node, sf, false};
+      channels[random() % CHANNELS].push_back(uplink);
+
+      uint32_t seconds = t / 1000000;
+      budget.record(seconds, airtime);
+      uint32_t next = budget.nextInterval(seconds, airtime, interval);
+
+      uint64_t cycle = (uint64_t)((airtime + RX_WINDOWS_US + next * 1000000ULL) * drift);
+      uint64_t dutyCycle = (uint64_t)airtime * DUTY_CYCLE_FACTOR;
+      t += std::max(cycle, dutyCycle);
+    }
+  }
+}
+
+// mark all uplinks that overlap another one with the same SF
+static void resolveCollisions(Channel &channel)
+{
+  std::sort(channel.begin(), channel.end(),
+            [](const Uplink &a, const Uplink &b) { return a.startUs < b.startUs; });
+
+  std::vector<size_t> active[SF_COUNT];
+  for (size_t i = 0; i < channel.size(); i++)
+  {
+    Uplink &uplink = channel[i];
+    std::vector<size_t> &running = active[uplink.sf - MIN_SF];
+
+    size_t kept = 0;
+    for (size_t j = 0; j < running.size(); j++)
+    {
+      Uplink &other = channel[running[j]];
+      if (other.endUs > uplink.startUs)
+      {
+        other.lost = true;
+        uplink.lost = true;
+        running[kept++] = running[j];
+      }
+    }
+    running.resize(kept);
+    running.push_back(i);
+  }
+}
+
+template <typename Function>
+static void parallel(uint32_t threads, uint32_t count, Function function)
+{
+  std::vector<std::thread> workers;
+  for (uint32_t t = 0; t < threads; t++)
+  {
+    workers.emplace_back([=]() {
+      for (uint32_t i = t; i < count; i += threads)
+      {
+        function(t, i);
+      }
+    });
+  }
+  for (std::thread &worker : workers)
+  {
+    worker.join();
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    fprintf(stderr, "usage: %s [--nodes n] [--hours h] [--interval s] [--interval-max s] "
+                    "[--sf 7..12 | --sf-mix sf:percent,...] [--payload bytes] [--budget-ms ms] "
+                    "[--threads n] [--seed n]\n",
+            argv[0]);
+    return 1;
+  }
+
+  uint32_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+  auto wallStart = std::chrono::steady_clock::now();
+
+  // schedules, every thread owns a block of nodes and its own channel lists
+  std::vector<std::vector<Channel>> perThread(threads, std::vector<Channel>(CHANNELS));
+  std::vector<uint8_t> nodeSf(options.nodes);
+  uint32_t block = (options.nodes + threads - 1) / threads;
+
+  parallel(threads, threads, [&](uint32_t, uint32_t t) {
+    uint32_t first = t * block;
+    uint32_t last = std::min(options.nodes, first + block);
+    if (first < last)
+    {
+      scheduleNodes(options, first, last, perThread[t].data(), nodeSf.data());
+    }
+  });
+
+  // collisions, every channel on its own
+  std::vector<Channel> channels(CHANNELS);
+  parallel(std::min<uint32_t>(threads, CHANNELS), CHANNELS, [&](uint32_t, uint32_t c) {
+    for (uint32_t t = 0; t < threads; t++)
+    {
+      channels[c].insert(channels[c].end(), perThread[t][c].begin(), perThread[t][c].end());
+      Channel().swap(perThread[t][c]);
+    }
+    resolveCollisions(channels[c]);
+  });
+
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  SfStatistics statistics[SF_COUNT] = {};
+  uint64_t sent = 0;
+  uint64_t delivered = 0;
+  uint64_t airtime = 0;
+  for (uint32_t node = 0; node < options.nodes; node++)
+  {
+    statistics[nodeSf[node] - MIN_SF].nodes++;
+  }
+  for (const Channel &channel : channels)
+  {
+    uint64_t channelAirtime = 0;
+    for (const Uplink &uplink : channel)
+    {
+      SfStatistics &sf = statistics[uplink.sf - MIN_SF];
+      sf.sent++;
+      sf.delivered += !uplink.lost;
+      sf.airtimeUs += uplink.endUs - uplink.startUs;
+      channelAirtime += uplink.endUs - uplink.startUs;
+    }
+    sent += channel.size();
+    airtime += channelAirtime;
+  }
+
+  printf("%u nodes, %u h, interval %u", options.nodes, options.hours, options.interval);
+  if (options.intervalMax > options.interval)
+  {
+    printf("..%u", options.intervalMax);
+  }
+  printf(" s, %u byte payload, budget %u ms/day, %u threads\n\n", options.payload, options.budgetMs, threads);
+
+  printf("SF  nodes   uplinks  delivered    PDR   airtime/node/day\n");
+  for (int i = 0; i < SF_COUNT; i++)
+  {
+    const SfStatistics &sf = statistics[i];
+    if (sf.nodes == 0)
+    {
+      continue;
+    }
+    printf("%2d %6u %9llu %10llu %5.1f%% %12.1f s\n", MIN_SF + i, sf.nodes,
+           (unsigned long long)sf.sent, (unsigned long long)sf.delivered,
+           sf.sent ? 100.0 * sf.delivered / sf.sent : 0.0,
+           sf.airtimeUs / 1e6 / sf.nodes * 24 / options.hours);
+    delivered += sf.delivered;
+  }
+
+  double seconds = options.hours * 3600.0;
+  printf("\nuplinks %llu, delivered %llu, PDR %.2f%%\n", (unsigned long long)sent,
+         (unsigned long long)delivered, sent ? 100.0 * delivered / sent : 0.0);
+  printf("channel load %.2f%% (airtime / time, mean of %d channels)\n",
+         100.0 * airtime / 1e6 / seconds / CHANNELS, CHANNELS);
+  printf("simulated in %.2f s\n", wallSeconds);
+  return 0;
+}
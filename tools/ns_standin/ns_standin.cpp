@@ -0,0 +1,564 @@
+/*
+ * Local stand-in for a gateway bridge and network server: speaks the
+ * Semtech UDP packet forwarder protocol and checks, counts and decrypts
+ * ABP uplinks with the keys of config/AppConfig.h.
+ *
+ * build: g++ -std=c++11 -O2 -DACTIVATION_MODE_ABP -I../../config -I../../lib/Payload -I../../lib/HostSim
+ *            -o ns_standin ns_standin.cpp ../../lib/HostSim/LoRaWANCrypto.cpp ../../lib/Payload/Payload.cpp
+ * usage: ns_standin [--port 1700] [--count N] [--quiet]
+ *        ns_standin --bench N [--host 127.0.0.1] [--port 1700] [--fcnt 0] [--gap-every 0]
+ *
+ * The server runs until N uplinks were received or Ctrl-C and then prints
+ * its statistics. Point the host simulation at it with
+ * `.pio/build/native/program 86400 127.0.0.1:1700`.
+ *
+ * --bench sends N valid uplinks of the configured device, one at a time,
+ * and waits for each PUSH_ACK; it reports uplinks per second and the
+ * round trip time. --gap-every k skips a frame counter after every k-th
+ * uplink, --fcnt sets the first one, e.g. 65530 to cross the 16 bit
+ * rollover.
+ *
+ * Frame counters are 32 bit, reconstructed from the 16 bits on air like
+ * a network server does. Counters that do not increase are rejected as
+ * replays, increases by more than one are counted as gaps.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <AppConfig.h>
+#include <Payload.hpp>
+#include <LoRaWANCrypto.hpp>
+
+#define PROTOCOL_VERSION 2
+#define PUSH_DATA 0x00
+#define PUSH_ACK 0x01
+#define PULL_DATA 0x02
+#define PULL_ACK 0x04
+
+#define MTYPE_UNCONFIRMED_UP 2
+#define MTYPE_CONFIRMED_UP 4
+
+// LoRaWAN 1.0 MHDR + DevAddr + FCtrl + FCnt, MIC
+#define FRAME_HEADER_SIZE 8
+#define FRAME_MIC_SIZE 4
+
+// a counter behind the last one by more than this rolled over
+#define FCNT_ROLLOVER_WINDOW 0x8000
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint32_t devAddr = TTN_DEVICE_ADDRESS;
+static const uint8_t nwkSKey[16] = TTN_NETWORK_SESSION_KEY;
+static const uint8_t appSKey[16] = TTN_APP_SESSION_KEY;
+
+static volatile sig_atomic_t stopped = 0;
+
+struct ServerStatistics
+{
+  uint32_t datagrams;
+  uint32_t uplinks;
+  uint32_t accepted;
+  uint32_t malformed;
+  uint32_t unknownDevice;
+  uint32_t micFailures;
+  uint32_t replays;
+  uint32_t gaps;
+  uint32_t lost;
+  uint32_t rollovers;
+  uint64_t decodeNs;
+  uint64_t maxDecodeNs;
+};
+
+struct Device
+{
+  bool seen;
+  uint32_t fcnt;
+};
+
+static uint32_t readUInt32(const uint8_t *data)
+{
+  return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void writeUInt32(uint8_t *data, uint32_t value)
+{
+  for (int i = 0; i < 4; i++)
+  {
+    data[i] = value >> (8 * i);
+  }
+}
+
+static int base64Value(char c)
+{
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == '+')
+    return 62;
+  if (c == '/')
+    return 63;
+  return -1;
+}
+
+static std::vector<uint8_t> base64Decode(const char *text, size_t length)
+{
+  std::vector<uint8_t> data;
+  uint32_t block = 0;
+  int bits = 0;
+
+  for (size_t i = 0; i < length; i++)
+  {
+    int value = base64Value(text[i]);
+    if (value < 0)
+    {
+      break;
+    }
+    block = (block << 6) | value;
+    bits += 6;
+    if (bits >= 8)
+    {
+      bits -= 8;
+      data.push_back(block >> bits);
+    }
+  }
+  return data;
+}
+
+static std::string base64Encode(const uint8_t *data, size_t length)
+{
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string text;
+
+  for (size_t i = 0; i < length; i += 3)
+  {
+    uint32_t block = (data[i] << 16) | (i + 1 < length ? data[i + 1] << 8 : 0) | (i + 2 < length ? data[i + 2] : 0);
+    text += alphabet[(block >> 18) & 0x3f];
+    text += alphabet[(block >> 12) & 0x3f];
+    text += i + 1 < length ? alphabet[(block >> 6) & 0x3f] : '=';
+    text += i + 2 < length ? alphabet[block & 0x3f] : '=';
+  }
+  return text;
+}
+
+// value of a "key": in a rxpk object, good enough for packet forwarder JSON
+static const char *jsonValue(const char *object, const char *end, const char *key)
+{
+  std::string pattern = std::string("\"") + key + "\":";
+  const char *found = std::search(object, end, pattern.begin(), pattern.end());
+  return found == end ? NULL : found + pattern.size();
+}
+
+// 32 bit frame counter from the 16 bits on air
+static uint32_t extendFcnt(const Device &device, uint16_t fcnt16, bool &rollover)
+{
+  rollover = false;
+  if (!device.seen)
+  {
+    return fcnt16;
+  }
+
+  uint32_t fcnt = (device.fcnt & 0xffff0000) | fcnt16;
+  if (fcnt < device.fcnt && device.fcnt - fcnt > FCNT_ROLLOVER_WINDOW)
+  {
+    fcnt += 0x10000;
+    rollover = true;
+  }
+  return fcnt;
+}
+
+static void processFrame(const std::vector<uint8_t> &frame, const char *rxpk, const char *rxpkEnd,
+                         Device &device, ServerStatistics &statistics, bool quiet)
+{
+  statistics.uplinks++;
+
+  uint8_t mtype = frame.size() > 0 ? frame[0] >> 5 : 0;
+  if (frame.size() < FRAME_HEADER_SIZE + FRAME_MIC_SIZE ||
+      (mtype != MTYPE_UNCONFIRMED_UP && mtype != MTYPE_CONFIRMED_UP))
+  {
+    statistics.malformed++;
+    return;
+  }
+
+  uint32_t address = readUInt32(&frame[1]);
+  if (address != devAddr)
+  {
+    statistics.unknownDevice++;
+    if (!quiet)
+    {
+      printf("unknown device %08X\n", address);
+    }
+    return;
+  }
+
+  uint8_t foptsLength = frame[5] & 0x0f;
+  uint16_t fcnt16 = frame[6] | (frame[7] << 8);
+  size_t micOffset = frame.size() - FRAME_MIC_SIZE;
+  size_t portOffset = FRAME_HEADER_SIZE + foptsLength;
+  if (portOffset > micOffset)
+  {
+    statistics.malformed++;
+    return;
+  }
+
+  bool rollover;
+  uint32_t fcnt = extendFcnt(device, fcnt16, rollover);
+  if (lorawanMic(nwkSKey, address, fcnt, 0, frame.data(), micOffset) != readUInt32(&frame[micOffset]))
+  {
+    statistics.micFailures++;
+    if (!quiet)
+    {
+      printf("%08X fcnt %u: MIC failed\n", address, fcnt);
+    }
+    return;
+  }
+
+  if (device.seen && fcnt <= device.fcnt)
+  {
+    statistics.replays++;
+    if (!quiet)
+    {
+      printf("%08X fcnt %u: replay, last %u\n", address, fcnt, device.fcnt);
+    }
+    return;
+  }
+
+  if (device.seen && fcnt != device.fcnt + 1)
+  {
+    statistics.gaps++;
+    statistics.lost += fcnt - device.fcnt - 1;
+    if (!quiet)
+    {
+      printf("%08X fcnt %u: gap, %u frames lost\n", address, fcnt, fcnt - device.fcnt - 1);
+    }
+  }
+  statistics.rollovers += rollover;
+  statistics.accepted++;
+  device.seen = true;
+  device.fcnt = fcnt;
+
+  // FPort 0 carries MAC commands encrypted with the network key
+  std::vector<uint8_t> payload;
+  int port = -1;
+  if (portOffset < micOffset)
+  {
+    port = frame[portOffset];
+    payload.assign(frame.begin() + portOffset + 1, frame.begin() + micOffset);
+    lorawanCrypt(port == 0 ? nwkSKey : appSKey, address, fcnt, 0, payload.data(), payload.size());
+  }
+
+  if (!quiet)
+  {
+    const char *rssi = jsonValue(rxpk, rxpkEnd, "rssi");
+    const char *datr = jsonValue(rxpk, rxpkEnd, "datr");
+    printf("%08X fcnt %u%s port %d rssi %d %.*s payload", address, fcnt,
+           mtype == MTYPE_CONFIRMED_UP ? " confirmed" : "", port, rssi ? atoi(rssi) : 0,
+           datr ? (int)(strcspn(datr + 1, "\"")) : 0, datr ? datr + 1 : "");
+    for (uint8_t byte : payload)
+    {
+      printf(" %02x", byte);
+    }
+    printf("\n");
+  }
+}
+
+// PUSH_DATA: 12 byte header, then {"rxpk":[{...},...],"stat":{...}}
+static void processPushData(const uint8_t *datagram, size_t length, Device &device,
+                            ServerStatistics &statistics, bool quiet)
+{
+  const char *json = (const char *)datagram + 12;
+  const char *end = (const char *)datagram + length;
+  const char *rxpk = jsonValue(json, end, "rxpk");
+
+  while (rxpk != NULL && rxpk < end)
+  {
+    const char *object = std::find(rxpk, end, '{');
+    const char *objectEnd = std::find(object, end, '}');
+    if (objectEnd == end)
+    {
+      break;
+    }
+
+    const char *data = jsonValue(object, objectEnd, "data");
+    if (data != NULL && *data == '"')
+    {
+      data++;
+      std::vector<uint8_t> frame = base64Decode(data, objectEnd - data);
+      processFrame(frame, object, objectEnd, device, statistics, quiet);
+    }
+
+    rxpk = objectEnd + 1;
+    if (rxpk < end && *rxpk == ']')
+    {
+      break;
+    }
+  }
+}
+
+static int openSocket(const char *host, const char *port, bool server)
+{
+  struct addrinfo hints = {};
+  struct addrinfo *address;
+  hints.ai_family = server ? AF_INET : AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = server ? AI_PASSIVE : 0;
+  if (getaddrinfo(host, port, &hints, &address) != 0)
+  {
+    fprintf(stderr, "cannot resolve %s:%s\n", host ? host : "*", port);
+    return -1;
+  }
+
+  int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+  if (fd >= 0 && (server ? bind(fd, address->ai_addr, address->ai_addrlen)
+                         : connect(fd, address->ai_addr, address->ai_addrlen)) != 0)
+  {
+    perror(port);
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(address);
+  return fd;
+}
+
+static void onSignal(int)
+{
+  stopped = 1;
+}
+
+static int runServer(const char *port, uint32_t count, bool quiet)
+{
+  int fd = openSocket(NULL, port, true);
+  if (fd < 0)
+  {
+    return 1;
+  }
+
+  // no SA_RESTART, recvfrom returns on Ctrl-C
+  struct sigaction action = {};
+  action.sa_handler = onSignal;
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  ServerStatistics statistics = {};
+  Device device = {};
+  Clock::time_point first, last;
+  uint8_t datagram[65536];
+
+  fprintf(stderr, "listening on udp port %s for device %08X\n", port, devAddr);
+
+  while (!stopped && (count == 0 || statistics.uplinks < count))
+  {
+    struct sockaddr_storage peer;
+    socklen_t peerLength = sizeof(peer);
+    ssize_t length = recvfrom(fd, datagram, sizeof(datagram), 0, (struct sockaddr *)&peer, &peerLength);
+    if (length < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      perror("recvfrom");
+      break;
+    }
+
+    Clock::time_point received = Clock::now();
+    statistics.datagrams++;
+    if (length < 4 || datagram[0] != PROTOCOL_VERSION)
+    {
+      continue;
+    }
+
+    uint8_t reply[4] = {PROTOCOL_VERSION, datagram[1], datagram[2], 0};
+    if (datagram[3] == PUSH_DATA && length >= 12)
+    {
+      reply[3] = PUSH_ACK;
+      sendto(fd, reply, sizeof(reply), 0, (struct sockaddr *)&peer, peerLength);
+
+      uint32_t uplinks = statistics.uplinks;
+      processPushData(datagram, length, device, statistics, quiet);
+      if (statistics.uplinks != uplinks)
+      {
+        last = Clock::now();
+        if (uplinks == 0)
+        {
+          first = received;
+        }
+        uint64_t decodeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(last - received).count();
+        statistics.decodeNs += decodeNs;
+        statistics.maxDecodeNs = std::max(statistics.maxDecodeNs, decodeNs);
+      }
+    }
+    else if (datagram[3] == PULL_DATA && length >= 12)
+    {
+      reply[3] = PULL_ACK;
+      sendto(fd, reply, sizeof(reply), 0, (struct sockaddr *)&peer, peerLength);
+    }
+  }
+  close(fd);
+
+  double seconds = std::chrono::duration<double>(last - first).count();
+  printf("\ndatagrams       : %u\n", statistics.datagrams);
+  printf("uplinks         : %u, %u accepted", statistics.uplinks, statistics.accepted);
+  if (statistics.uplinks > 1 && seconds > 0)
+  {
+    printf(", %.0f per second", (statistics.uplinks - 1) / seconds);
+  }
+  printf("\nrejected        : %u MIC, %u replay, %u unknown device, %u malformed\n",
+         statistics.micFailures, statistics.replays, statistics.unknownDevice, statistics.malformed);
+  printf("fcnt            : last %u, %u gaps, %u frames lost, %u rollovers\n",
+         device.fcnt, statistics.gaps, statistics.lost, statistics.rollovers);
+  if (statistics.uplinks > 0)
+  {
+    printf("decode latency  : mean %.1f us, max %.1f us\n",
+           statistics.decodeNs / 1e3 / statistics.uplinks, statistics.maxDecodeNs / 1e3);
+  }
+  return 0;
+}
+
+// an unconfirmed ABP uplink on FPort 1 with a version 1 payload
+static std::vector<uint8_t> buildUplink(uint32_t fcnt)
+{
+  Reading reading = {fcnt, 3700, -60};
+  uint8_t payload[PAYLOAD_READING_SIZE];
+  size_t payloadLength = payloadEncodeReading(payload, sizeof(payload), reading);
+
+  std::vector<uint8_t> frame(FRAME_HEADER_SIZE + 1 + payloadLength + FRAME_MIC_SIZE);
+  frame[0] = MTYPE_UNCONFIRMED_UP << 5;
+  writeUInt32(&frame[1], devAddr);
+  frame[5] = 0;
+  frame[6] = fcnt;
+  frame[7] = fcnt >> 8;
+  frame[8] = 1;
+  lorawanCrypt(appSKey, devAddr, fcnt, 0, payload, payloadLength);
+  memcpy(&frame[9], payload, payloadLength);
+
+  size_t micOffset = frame.size() - FRAME_MIC_SIZE;
+  writeUInt32(&frame[micOffset], lorawanMic(nwkSKey, devAddr, fcnt, 0, frame.data(), micOffset));
+  return frame;
+}
+
+static int runBench(const char *host, const char *port, uint32_t count, uint32_t fcnt, uint32_t gapEvery)
+{
+  int fd = openSocket(host, port, false);
+  if (fd < 0)
+  {
+    return 1;
+  }
+
+  struct timeval timeout = {1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  const uint8_t gatewayEui[8] = {0xAA, 0x55, 0x5A, 0x00, 0x00, 0x00, 0x00, 0x02};
+  uint32_t acked = 0;
+  uint32_t skipped = 0;
+  uint64_t roundTripNs = 0;
+  uint64_t maxRoundTripNs = 0;
+  Clock::time_point start = Clock::now();
+
+  for (uint32_t i = 0; i < count; i++, fcnt++)
+  {
+    if (gapEvery > 0 && i > 0 && i % gapEvery == 0)
+    {
+      fcnt++;
+      skipped++;
+    }
+
+    std::vector<uint8_t> frame = buildUplink(fcnt);
+    char json[256];
+    int length = snprintf(json, sizeof(json),
+                          "{\"rxpk\":[{\"tmst\":%u,\"chan\":0,\"rfch\":0,\"freq\":868.100000,\"stat\":1,"
+                          "\"modu\":\"LORA\",\"datr\":\"SF7BW125\",\"codr\":\"4/5\",\"rssi\":-60,"
+                          "\"lsnr\":8.0,\"size\":%u,\"data\":\"%s\"}]}",
+                          i * 60000000u, (unsigned)frame.size(), base64Encode(frame.data(), frame.size()).c_str());
+
+    uint16_t token = i;
+    std::vector<uint8_t> datagram = {PROTOCOL_VERSION, (uint8_t)(token >> 8), (uint8_t)token, PUSH_DATA};
+    datagram.insert(datagram.end(), gatewayEui, gatewayEui + sizeof(gatewayEui));
+    datagram.insert(datagram.end(), json, json + length);
+
+    Clock::time_point sent = Clock::now();
+    if (send(fd, datagram.data(), datagram.size(), 0) < 0)
+    {
+      perror("send");
+      break;
+    }
+
+    uint8_t reply[16];
+    ssize_t replyLength;
+    while ((replyLength = recv(fd, reply, sizeof(reply), 0)) >= 4)
+    {
+      if (reply[0] == PROTOCOL_VERSION && reply[3] == PUSH_ACK && reply[1] == datagram[1] && reply[2] == datagram[2])
+      {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sent).count();
+        roundTripNs += ns;
+        maxRoundTripNs = std::max(maxRoundTripNs, ns);
+        acked++;
+        break;
+      }
+    }
+  }
+  close(fd);
+
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  printf("sent            : %u uplinks in %.3f s, %.0f per second\n", count, seconds, count / seconds);
+  printf("acknowledged    : %u\n", acked);
+  printf("fcnt gaps       : %u, last fcnt %u\n", skipped, fcnt - 1);
+  if (acked > 0)
+  {
+    printf("round trip      : mean %.1f us, max %.1f us\n", roundTripNs / 1e3 / acked, maxRoundTripNs / 1e3);
+  }
+  return acked == count ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *host = "127.0.0.1";
+  const char *port = "1700";
+  uint32_t count = 0;
+  uint32_t bench = 0;
+  uint32_t fcnt = 0;
+  uint32_t gapEvery = 0;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(argv[i], "--port") && hasValue)
+      port = argv[++i];
+    else if (!strcmp(argv[i], "--host") && hasValue)
+      host = argv[++i];
+    else if (!strcmp(argv[i], "--count") && hasValue)
+      count = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--bench") && hasValue)
+      bench = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--fcnt") && hasValue)
+      fcnt = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--gap-every") && hasValue)
+      gapEvery = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--quiet"))
+      quiet = true;
+    else
+    {
+      fprintf(stderr, "usage: %s [--port 1700] [--count N] [--quiet]\n"
+                      "       %s --bench N [--host 127.0.0.1] [--port 1700] [--fcnt 0] [--gap-every 0]\n",
+              argv[0], argv[0]);
+      return 1;
+    }
+  }
+
+  return bench > 0 ? runBench(host, port, bench, fcnt, gapEvery) : runServer(port, count, quiet);
+}
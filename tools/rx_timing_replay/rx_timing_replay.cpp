@@ -0,0 +1,86 @@
+/*
+ * Replays the "rx timing" lines of a serial log (text output or
+ * binlog_decode output) into the RxTiming statistics of the firmware.
+ *
+ * build: g++ -std=c++11 -I../../lib/RxTiming -o rx_timing_replay rx_timing_replay.cpp ../../lib/RxTiming/RxTiming.cpp
+ * usage: rx_timing_replay serial.log   (or read from stdin)
+ *
+ * Prints the jitter per RX window, the smallest LMIC_setClockError()
+ * value that covers the latest window opening seen, and how long after
+ * the DIO0 edge LMIC noticed TX done (polled DIO lines only).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <RxTiming.hpp>
+
+int main(int argc, char *argv[])
+{
+  FILE *input = stdin;
+  if (argc > 1)
+  {
+    input = fopen(argv[1], "r");
+    if (input == NULL)
+    {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  RxTiming rxTiming;
+  rxTiming.reset();
+  uint32_t polled = 0;
+  int32_t maxPollUs = 0;
+  int64_t sumPollUs = 0;
+
+  char line[256];
+  while (fgets(line, sizeof(line), input) != NULL)
+  {
+    const char *record = strstr(line, "rx timing:");
+    unsigned window, txDone, scheduled, opened, dio0, dio1;
+
+    if (record == NULL)
+    {
+      continue;
+    }
+    int fields = sscanf(record, "rx timing: window %u, tx done %u us, scheduled %u us, opened %u us, dio0 %u us, dio1 %u us",
+                        &window, &txDone, &scheduled, &opened, &dio0, &dio1);
+    if (fields >= 4 && window >= 1)
+    {
+      rxTiming.windowOpened(window - 1, txDone, scheduled, opened);
+    }
+    // before RX1 the last DIO0 edge is TX done
+    if (fields == 6 && window == 1 && dio0 != 0)
+    {
+      int32_t poll = (int32_t)(txDone - dio0);
+      polled++;
+      sumPollUs += poll;
+      if (poll > maxPollUs)
+      {
+        maxPollUs = poll;
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < RX_TIMING_WINDOWS; i++)
+  {
+    const RxWindowStatistics &statistics = rxTiming.getStatistics(i);
+    if (statistics.count == 0)
+    {
+      printf("RX%u: no windows\n", i + 1);
+      continue;
+    }
+    printf("RX%u: %u windows, %u late, jitter min %d us, mean %d us, max %d us, delay %u us\n",
+           i + 1, statistics.count, statistics.late, statistics.minJitterUs,
+           rxTiming.getMeanJitterUs(i), statistics.maxJitterUs, statistics.minDelayUs);
+  }
+
+  if (polled > 0)
+  {
+    printf("TX done seen after the DIO0 edge: mean %d us, max %d us\n", (int32_t)(sumPollUs / polled), maxPollUs);
+  }
+
+  uint32_t clockError = rxTiming.suggestedClockError();
+  printf("LMIC_setClockError(%u) // %.3f %%\n", clockError, clockError * 100.0 / RX_TIMING_MAX_CLOCK_ERROR);
+  return 0;
+}